@@ -0,0 +1,314 @@
+#include "binary_log.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+namespace binary_log {
+    namespace {
+        // Formats one argument as std::format would with the replacement field `{:spec}`, so a
+        // decoded record reads like the text log; false when the spec does not fit the argument
+        bool append_arg(std::string& out, const Arg& arg, std::string_view spec) {
+            std::string field = "{:";
+            field += spec;
+            field += '}';
+            try {
+                std::visit(
+                    [&](const auto& value) {
+                        using T = std::decay_t<decltype(value)>;
+                        if constexpr (std::is_same_v<T, std::monostate>) {
+                            std::string_view null = "null";
+                            out += std::vformat(field, std::make_format_args(null));
+                        } else {
+                            out += std::vformat(field, std::make_format_args(value));
+                        }
+                    },
+                    arg
+                );
+                return true;
+            } catch (const std::format_error&) {
+                return false;
+            }
+        }
+
+        Arg borrow(const OwnedArg& arg) {
+            return std::visit(
+                [](const auto& value) -> Arg {
+                    using T = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_same_v<T, std::string>) return std::string_view{value};
+                    else return value;
+                },
+                arg
+            );
+        }
+    }
+
+    std::string format_record(std::string_view format, std::span<const Arg> args) {
+        std::string out;
+        out.reserve(format.size() + args.size() * 8);
+
+        // Replacement fields are `{[index][:spec]}`. A field the decoder cannot honor is kept in
+        // the output, marked with `!`, rather than dropped
+        size_t next_arg = 0;
+        for (size_t i = 0; i < format.size(); i++) {
+            char c = format[i];
+            if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+                out += c;
+                i++;
+                continue;
+            }
+            size_t close = c == '{' ? format.find('}', i + 1) : std::string_view::npos;
+            if (close == std::string_view::npos) {
+                out += c;
+                continue;
+            }
+
+            std::string_view field = format.substr(i + 1, close - i - 1);
+            std::string_view index = field.substr(0, field.find(':'));
+            std::string_view spec  = index.size() < field.size() ? field.substr(index.size() + 1)
+                                                                 : std::string_view{};
+            size_t arg     = next_arg;
+            bool   indexed = !index.empty();
+            bool   valid   = true;
+            if (indexed) {
+                auto [end, ec] = std::from_chars(index.data(), index.data() + index.size(), arg);
+                valid          = ec == std::errc{} && end == index.data() + index.size();
+            } else {
+                next_arg++;
+            }
+
+            if (!valid || arg >= args.size() || !append_arg(out, args[arg], spec)) {
+                out += "{!";
+                out += field;
+                out += '}';
+            }
+            if (indexed && valid) next_arg = std::max(next_arg, arg + 1);
+            i = close;
+        }
+
+        // Events may carry more arguments than placeholders (e.g. console.event("tick", a, b))
+        for (; next_arg < args.size(); next_arg++) {
+            out += ' ';
+            append_arg(out, args[next_arg], {});
+        }
+        return out;
+    }
+
+    std::string format_record(std::string_view format, std::span<const OwnedArg> args) {
+        std::vector<Arg> borrowed;
+        borrowed.reserve(args.size());
+        for (const auto& arg : args) borrowed.push_back(borrow(arg));
+        return format_record(format, borrowed);
+    }
+}
+
+bool BinaryLogWriter::open(const std::filesystem::path& path) {
+    close();
+#ifdef _WIN32
+    file_ = _wfopen(path.c_str(), L"wb");
+#else
+    file_ = fopen(path.c_str(), "wb");
+#endif
+    if (!file_) return false;
+
+    buffer_.reserve(64 * 1024);
+    put(binary_log::magic, sizeof(binary_log::magic));
+    put_value(binary_log::version);
+    put_value(uint16_t{0});
+    return true;
+}
+
+void BinaryLogWriter::close() {
+    if (!file_) return;
+    flush();
+    fclose(file_);
+    file_ = nullptr;
+    formats_.clear();
+}
+
+void BinaryLogWriter::flush() {
+    if (!file_ || buffer_.empty()) return;
+    fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    fflush(file_);
+    buffer_.clear();
+}
+
+void BinaryLogWriter::put(const void* data, size_t size) {
+    if (buffer_.size() + size > buffer_.capacity()) flush();
+    auto* bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+}
+
+uint32_t BinaryLogWriter::intern_format(std::string_view format) {
+    if (auto it = formats_.find(format); it != formats_.end()) return it->second;
+
+    auto id = static_cast<uint32_t>(formats_.size());
+    formats_.emplace(format, id);
+
+    put_value(binary_log::RecordKind::Format);
+    put_value(id);
+    put_value(static_cast<uint32_t>(format.size()));
+    put(format.data(), format.size());
+    return id;
+}
+
+void BinaryLogWriter::write_event(uint32_t format_id, std::span<const binary_log::Arg> args) {
+    if (!file_) return;
+
+    using namespace std::chrono;
+    auto timestamp = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+
+    put_value(binary_log::RecordKind::Event);
+    put_value(static_cast<uint64_t>(timestamp));
+    put_value(format_id);
+    put_value(static_cast<uint8_t>(std::min<size_t>(args.size(), UINT8_MAX)));
+
+    for (size_t i = 0; i < args.size() && i < UINT8_MAX; i++) {
+        std::visit(
+            [this](const auto& value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, std::monostate>) {
+                    put_value(binary_log::ArgTag::Null);
+                } else if constexpr (std::is_same_v<T, bool>) {
+                    put_value(binary_log::ArgTag::Bool);
+                    put_value(static_cast<uint8_t>(value));
+                } else if constexpr (std::is_same_v<T, int64_t>) {
+                    put_value(binary_log::ArgTag::Int);
+                    put_value(value);
+                } else if constexpr (std::is_same_v<T, double>) {
+                    put_value(binary_log::ArgTag::Float);
+                    put_value(value);
+                } else {
+                    put_value(binary_log::ArgTag::String);
+                    put_value(static_cast<uint32_t>(value.size()));
+                    put(value.data(), value.size());
+                }
+            },
+            args[i]
+        );
+    }
+}
+
+bool BinaryLogReader::open(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error_ = "cannot open " + path.string();
+        return false;
+    }
+    data_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    char     magic[4];
+    uint16_t version  = 0;
+    uint16_t reserved = 0;
+    if (!read(magic, sizeof(magic)) || memcmp(magic, binary_log::magic, sizeof(magic)) != 0 ||
+        !read(&version, sizeof(version)) || !read(&reserved, sizeof(reserved))) {
+        error_ = "not a binary log file";
+        return false;
+    }
+    if (version != binary_log::version) {
+        error_ = "unsupported binary log version " + std::to_string(version);
+        return false;
+    }
+    return true;
+}
+
+bool BinaryLogReader::read(void* data, size_t size) {
+    if (data_.size() - offset_ < size) return false;
+    memcpy(data, data_.data() + offset_, size);
+    offset_ += size;
+    return true;
+}
+
+bool BinaryLogReader::next(Event& event) {
+    while (offset_ < data_.size()) {
+        binary_log::RecordKind kind;
+        if (!read(&kind, sizeof(kind))) break;
+
+        if (kind == binary_log::RecordKind::Format) {
+            uint32_t id = 0, length = 0;
+            if (!read(&id, sizeof(id)) || !read(&length, sizeof(length)) ||
+                data_.size() - offset_ < length) {
+                error_ = "truncated format record";
+                return false;
+            }
+            formats_[id].assign(reinterpret_cast<const char*>(data_.data() + offset_), length);
+            offset_ += length;
+            continue;
+        }
+
+        if (kind != binary_log::RecordKind::Event) {
+            error_ = "unknown record kind " + std::to_string(static_cast<int>(kind));
+            return false;
+        }
+
+        uint32_t format_id = 0;
+        uint8_t  argc      = 0;
+        if (!read(&event.timestamp_ns, sizeof(event.timestamp_ns)) ||
+            !read(&format_id, sizeof(format_id)) || !read(&argc, sizeof(argc))) {
+            error_ = "truncated event record";
+            return false;
+        }
+
+        auto format = formats_.find(format_id);
+        if (format == formats_.end()) {
+            error_ = "event references unknown format " + std::to_string(format_id);
+            return false;
+        }
+        event.format = format->second;
+
+        event.args.clear();
+        for (uint8_t i = 0; i < argc; i++) {
+            binary_log::ArgTag tag;
+            if (!read(&tag, sizeof(tag))) {
+                error_ = "truncated event argument";
+                return false;
+            }
+            bool ok = true;
+            switch (tag) {
+                case binary_log::ArgTag::Null:
+                    event.args.emplace_back(std::monostate{});
+                    break;
+                case binary_log::ArgTag::Bool: {
+                    uint8_t value = 0;
+                    ok            = read(&value, sizeof(value));
+                    event.args.emplace_back(value != 0);
+                    break;
+                }
+                case binary_log::ArgTag::Int: {
+                    int64_t value = 0;
+                    ok            = read(&value, sizeof(value));
+                    event.args.emplace_back(value);
+                    break;
+                }
+                case binary_log::ArgTag::Float: {
+                    double value = 0;
+                    ok           = read(&value, sizeof(value));
+                    event.args.emplace_back(value);
+                    break;
+                }
+                case binary_log::ArgTag::String: {
+                    uint32_t length = 0;
+                    ok = read(&length, sizeof(length)) && data_.size() - offset_ >= length;
+                    if (ok) {
+                        event.args.emplace_back(std::string(
+                            reinterpret_cast<const char*>(data_.data() + offset_), length
+                        ));
+                        offset_ += length;
+                    }
+                    break;
+                }
+                default:
+                    ok = false;
+            }
+            if (!ok) {
+                error_ = "corrupt event argument";
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// Binary log file layout (all integers little-endian)
+//
+//   header:  "JSBL" u16 version u16 reserved
+//   record:  u8 kind, then
+//     BinaryLogRecord::Format  u32 format_id, u32 length, <length bytes of format string>
+//     BinaryLogRecord::Event   u64 timestamp_ns, u32 format_id, u8 argc, argc * <arg>
+//   arg:     u8 BinaryLogArgTag, then the raw value (strings are u32 length + bytes)
+//
+// Format strings use std::format replacement fields and are written once, before the first event
+// using them, so a log file can be decoded without access to the binary that produced it.
+namespace binary_log {
+    constexpr char     magic[4] = {'J', 'S', 'B', 'L'};
+    constexpr uint16_t version  = 1;
+
+    enum class RecordKind : uint8_t { Format = 1, Event = 2 };
+    enum class ArgTag : uint8_t { Null = 0, Bool = 1, Int = 2, Float = 3, String = 4 };
+
+    using Arg      = std::variant<std::monostate, bool, int64_t, double, std::string_view>;
+    using OwnedArg = std::variant<std::monostate, bool, int64_t, double, std::string>;
+
+    // Substitutes the std::format replacement fields in `format` (`{}`, `{1}`, `{:>8.2f}`; "{{"
+    // and "}}" are escapes) with the arguments; a field naming a missing argument or a spec the
+    // argument's type rejects comes out as `{!field}`
+    std::string format_record(std::string_view format, std::span<const Arg> args);
+    std::string format_record(std::string_view format, std::span<const OwnedArg> args);
+}
+
+// Buffered writer for the binary log format
+//
+// Not thread-safe: events are written from the thread that owns the JS runtime.
+class BinaryLogWriter {
+public:
+    BinaryLogWriter() = default;
+    ~BinaryLogWriter() { close(); }
+
+    BinaryLogWriter(const BinaryLogWriter&)            = delete;
+    BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool is_open() const { return file_ != nullptr; }
+    void flush();
+
+    // Returns the id for `format`, writing its definition record the first time it is seen
+    uint32_t intern_format(std::string_view format);
+
+    void write_event(uint32_t format_id, std::span<const binary_log::Arg> args);
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    void put(const void* data, size_t size);
+    template <class T>
+    void put_value(T value) {
+        put(&value, sizeof(value));
+    }
+
+    FILE*                                                             file_ = nullptr;
+    std::vector<uint8_t>                                              buffer_;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> formats_;
+};
+
+// Reads records back out of a binary log file (used by the offline decoder)
+class BinaryLogReader {
+public:
+    struct Event {
+        uint64_t                           timestamp_ns = 0;
+        std::string_view                   format;
+        std::vector<binary_log::OwnedArg> args;
+    };
+
+    bool open(const std::filesystem::path& path);
+
+    // Reads the next event, consuming any format records before it. Returns false at the end of
+    // the file or on a truncated/corrupt record (check error() to tell them apart).
+    bool next(Event& event);
+
+    const std::string& error() const { return error_; }
+
+private:
+    bool read(void* data, size_t size);
+
+    std::vector<uint8_t>                         data_;
+    size_t                                       offset_ = 0;
+    std::unordered_map<uint32_t, std::string>    formats_;
+    std::string                                  error_;
+};
@@ -0,0 +1,55 @@
+#include "console_quota.h"
+
+#include <algorithm>
+
+TokenBucket::TokenBucket(double rate, double burst, clock::time_point now)
+    : rate_(rate), burst_(burst), tokens_(burst), last_refill_(now) {}
+
+void TokenBucket::refill(clock::time_point now) {
+    if (now <= last_refill_) return;
+    std::chrono::duration<double> elapsed = now - last_refill_;
+    tokens_      = std::min(burst_, tokens_ + elapsed.count() * rate_);
+    last_refill_ = now;
+}
+
+ConsoleQuota::ConsoleQuota(const ConsoleQuotaLimits& limits)
+    : lines_(limits.lines_per_second, limits.line_burst),
+      bytes_(limits.bytes_per_second, limits.byte_burst),
+      report_interval_(limits.report_interval),
+      last_report_(clock::now()) {}
+
+bool ConsoleQuota::has_line_budget(clock::time_point now) {
+    lines_.refill(now);
+    return lines_.has(1);
+}
+
+bool ConsoleQuota::admit(size_t bytes, clock::time_point now) {
+    lines_.refill(now);
+    bytes_.refill(now);
+
+    // A single line larger than the burst would never fit, so it only has to drain the bucket
+    double byte_cost = std::min(static_cast<double>(bytes), bytes_.burst());
+
+    if (!lines_.has(1) || !bytes_.has(byte_cost)) {
+        suppressed_.lines++;
+        suppressed_.bytes += bytes;
+        return false;
+    }
+
+    lines_.take(1);
+    bytes_.take(byte_cost);
+    return true;
+}
+
+std::optional<SuppressedConsoleOutput> ConsoleQuota::take_report(clock::time_point now) {
+    if (suppressed_.lines == 0 || now - last_report_ < report_interval_) return std::nullopt;
+    last_report_ = now;
+    return flush_report();
+}
+
+std::optional<SuppressedConsoleOutput> ConsoleQuota::flush_report() {
+    if (suppressed_.lines == 0) return std::nullopt;
+    auto report = suppressed_;
+    suppressed_ = {};
+    return report;
+}
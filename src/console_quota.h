@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Token bucket refilled continuously at `rate` tokens per second, holding at most `burst`
+class TokenBucket {
+public:
+    using clock = std::chrono::steady_clock;
+
+    TokenBucket(double rate, double burst, clock::time_point now = clock::now());
+
+    void   refill(clock::time_point now);
+    bool   has(double tokens) const { return tokens_ >= tokens; }
+    void   take(double tokens) { tokens_ -= tokens; }
+    double burst() const { return burst_; }
+
+private:
+    double            rate_;
+    double            burst_;
+    double            tokens_;
+    clock::time_point last_refill_;
+};
+
+struct ConsoleQuotaLimits {
+    double               lines_per_second = 50;
+    double               line_burst       = 200;
+    double               bytes_per_second = 16 * 1024;
+    double               byte_burst       = 64 * 1024;
+    std::chrono::seconds report_interval{5};
+};
+
+struct SuppressedConsoleOutput {
+    uint64_t lines = 0;
+    uint64_t bytes = 0;
+};
+
+// Per-context console output quota (lines and bytes per second)
+//
+// Output that does not fit the quota is dropped and counted. The counts are handed back through
+// take_report() at most once per report interval so the caller can log a single summary line.
+class ConsoleQuota {
+public:
+    using clock = std::chrono::steady_clock;
+
+    ConsoleQuota() : ConsoleQuota(ConsoleQuotaLimits{}) {}
+    explicit ConsoleQuota(const ConsoleQuotaLimits& limits);
+
+    // Cheap pre-check so callers can skip formatting a line that would be dropped anyway
+    bool has_line_budget(clock::time_point now);
+
+    // Takes one line and `bytes` bytes from the quota, or records the line as suppressed
+    bool admit(size_t bytes, clock::time_point now);
+
+    // Records a line that was dropped before its size was known
+    void suppress_line() { suppressed_.lines++; }
+
+    // Returns the suppressed totals once the report interval has elapsed since the last report
+    std::optional<SuppressedConsoleOutput> take_report(clock::time_point now);
+
+    // Returns whatever is left unreported, regardless of the interval (used at teardown)
+    std::optional<SuppressedConsoleOutput> flush_report();
+
+private:
+    TokenBucket             lines_;
+    TokenBucket             bytes_;
+    clock::duration         report_interval_;
+    clock::time_point       last_report_;
+    SuppressedConsoleOutput suppressed_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory_resource>
+#include <string>
+
+#include "console_quota.h"
+#include "global_registry.h"
+#include "js_limits.h"
+#include "papyrus_class_table.h"
+#include "papyrus_latent.h"
+#include "papyrus_native_table.h"
+#include "pending_promises.h"
+#include "psc_index.h"
+#include "quickjs.h"
+#include "scratch_arena.h"
+
+// Native state owned by a single JSContext, stored as the context opaque
+struct ContextState {
+    std::string           name;  // selects the [limits.<name>] config section
+    JSLimits              limits;
+    MemoryPressureTracker memory_pressure;
+    GlobalRegistry        globals;          // released by destroy_context_state
+    PapyrusNativeTable    papyrus_natives;  // released by destroy_context_state
+    PapyrusClassTable     papyrus_classes;  // released by destroy_context_state
+    PendingPromises       papyrus_calls;    // released by destroy_context_state
+    PendingLatentCalls    latent_calls;     // cancelled by destroy_context_state
+    ConsoleQuota          console_quota;
+    PscIndex              source_index;  // Papyrus sources indexed through Psc.index
+    ScratchArena          scratch;  // reset when the outermost evaluation finishes
+    int                   scratch_depth = 0;
+};
+
+inline ContextState* get_context_state(JSContext* ctx) {
+    return static_cast<ContextState*>(JS_GetContextOpaque(ctx));
+}
+
+// Memory for native temporaries that only need to live until the current evaluation ends
+//
+// The arena is only handed out inside a ScratchScope, whose end resets it. Other entry points
+// (Papyrus natives, class methods, promise settlement from the frame pump) never reset it, so
+// they get the default heap instead.
+inline std::pmr::memory_resource* scratch_memory(JSContext* ctx) {
+    auto* state = get_context_state(ctx);
+    if (state->scratch_depth == 0) return std::pmr::get_default_resource();
+    return &state->scratch;
+}
+
+// Releases the JS values the state holds and deletes it; must run before JS_FreeContext
+inline void destroy_context_state(JSContext* ctx) {
+    auto* state = get_context_state(ctx);
+    if (!state) return;
+    state->globals.clear(ctx);
+    state->papyrus_natives.clear(ctx);
+    state->papyrus_classes.clear(ctx);
+    state->papyrus_calls.clear(ctx);
+    state->latent_calls.clear(ctx);
+    JS_SetContextOpaque(ctx, nullptr);
+    delete state;
+}
@@ -0,0 +1,295 @@
+#include "editor_id_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+static_assert(std::endian::native == std::endian::little, "the index is read in place");
+
+namespace {
+    struct Header {
+        char     magic[4];
+        uint16_t version;
+        uint16_t block_size;
+        uint64_t load_order_hash;
+        uint32_t entry_count;
+        uint32_t block_count;
+        uint32_t heads_offset;
+        uint32_t blocks_offset;
+        uint32_t blocks_size;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(Header) == 40);
+
+    constexpr size_t prefix_length = 16;
+
+    // ASCII case folding, as in FormCache
+    char fold(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; }
+}
+
+// The first 16 bytes of a key, zero-padded, as two big-endian integers: comparing two prefixes
+// orders them like comparing the bytes
+struct EditorIdIndex::Prefix {
+    uint64_t high = 0;
+    uint64_t low  = 0;
+
+    Prefix() = default;
+    explicit Prefix(std::string_view key) {
+        for (size_t i = 0; i < prefix_length; i++) {
+            uint64_t  byte = i < key.size() ? static_cast<uint8_t>(key[i]) : 0;
+            uint64_t& half = i < 8 ? high : low;
+            half           = (half << 8) | byte;
+        }
+    }
+
+    auto operator<=>(const Prefix&) const = default;
+};
+
+struct EditorIdIndex::Head {
+    Prefix   prefix;
+    uint32_t offset;      // of the block in the block area
+    uint16_t size;        // of the block in bytes
+    uint8_t  key_length;  // of the block's first key
+    uint8_t  count;       // entries in the block
+};
+
+void LoadOrderHash::add_file(std::string_view name, uint64_t size, int64_t modified) {
+    add(name.data(), name.size());
+    add("", 1);  // keeps "a" + "bc" apart from "ab" + "c"
+    add(&size, sizeof(size));
+    add(&modified, sizeof(modified));
+}
+
+void LoadOrderHash::add(const void* data, size_t size) {
+    auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) hash_ = (hash_ ^ bytes[i]) * 1099511628211ull;
+}
+
+bool EditorIdIndex::open(const std::filesystem::path& path) {
+    close();
+    auto fail = [this](std::string error) {
+        close();
+        error_ = std::move(error);
+        return false;
+    };
+
+    if (!file_.open(path)) return fail(file_.error());
+    auto data = file_.data();
+
+    Header header;
+    if (data.size() < sizeof(header)) return fail("file is too small to be an editor ID index");
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, editor_id_index::magic, sizeof(header.magic)) != 0)
+        return fail("not an editor ID index");
+    if (header.version != editor_id_index::version)
+        return fail("unsupported index version " + std::to_string(header.version));
+
+    uint64_t blocks = header.block_count;
+    if (header.block_size != editor_id_index::block_size ||
+        blocks != (uint64_t{header.entry_count} + header.block_size - 1) / header.block_size)
+        return fail("index has an unexpected block layout");
+    if (header.heads_offset % alignof(Head) != 0 ||
+        header.heads_offset + blocks * sizeof(Head) > data.size() ||
+        uint64_t{header.blocks_offset} + header.blocks_size > data.size())
+        return fail("index is truncated");
+
+    // The search trusts the heads to point inside the block area, so check them once here
+    auto* heads = reinterpret_cast<const Head*>(data.data() + header.heads_offset);
+    for (size_t i = 0; i < blocks; i++) {
+        const auto& head = heads[i];
+        if (uint64_t{head.offset} + head.size > header.blocks_size ||
+            head.size < 2 + head.key_length || head.count == 0 ||
+            head.count > editor_id_index::block_size)
+            return fail("index has a damaged head table");
+    }
+
+    heads_           = heads;
+    blocks_          = data.data() + header.blocks_offset;
+    entry_count_     = header.entry_count;
+    block_count_     = header.block_count;
+    load_order_hash_ = header.load_order_hash;
+    error_.clear();
+    return true;
+}
+
+void EditorIdIndex::close() {
+    file_.close();
+    heads_           = nullptr;
+    blocks_          = nullptr;
+    entry_count_     = 0;
+    block_count_     = 0;
+    load_order_hash_ = 0;
+}
+
+bool EditorIdIndex::build(
+    const std::filesystem::path& path, uint64_t load_order_hash, std::vector<EditorIdEntry> entries
+) {
+    using editor_id_index::block_size;
+    close();
+
+    // Editor IDs differing only in case are one key; the first entry given for it wins
+    for (auto& entry : entries)
+        for (auto& c : entry.editor_id) c = fold(c);
+    std::erase_if(entries, [](const EditorIdEntry& entry) {
+        return entry.editor_id.empty() || entry.editor_id.size() > editor_id_index::max_key_length;
+    });
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.editor_id < b.editor_id;
+    });
+    entries.erase(
+        std::unique(
+            entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.editor_id == b.editor_id; }
+        ),
+        entries.end()
+    );
+
+    std::vector<Head>    sorted_heads;
+    std::vector<uint8_t> blocks;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const auto& key    = entries[i].editor_id;
+        size_t      shared = 0;
+        if (i % block_size == 0) {
+            auto offset     = static_cast<uint32_t>(blocks.size());
+            auto key_length = static_cast<uint8_t>(key.size());
+            sorted_heads.push_back({Prefix(key), offset, 0, key_length, 0});
+        } else {
+            const auto& previous = entries[i - 1].editor_id;
+            while (shared < key.size() && shared < previous.size() &&
+                   key[shared] == previous[shared])
+                shared++;
+        }
+        blocks.push_back(static_cast<uint8_t>(shared));
+        blocks.push_back(static_cast<uint8_t>(key.size() - shared));
+        blocks.insert(blocks.end(), key.begin() + shared, key.end());
+        auto* form_id = reinterpret_cast<const uint8_t*>(&entries[i].form_id);
+        blocks.insert(blocks.end(), form_id, form_id + sizeof(uint32_t));
+
+        auto& head = sorted_heads.back();
+        head.size  = static_cast<uint16_t>(blocks.size() - head.offset);
+        head.count++;
+    }
+
+    // Eytzinger order: the sorted heads laid out as an implicit binary tree, root first, so the
+    // first steps of every search share the same few cache lines
+    std::vector<Head>           heads(sorted_heads.size());
+    size_t                      next  = 0;
+    std::function<void(size_t)> place = [&](size_t k) {
+        if (k > heads.size()) return;
+        place(2 * k);
+        heads[k - 1] = sorted_heads[next++];
+        place(2 * k + 1);
+    };
+    place(1);
+
+    Header header{};
+    memcpy(header.magic, editor_id_index::magic, sizeof(header.magic));
+    header.version         = editor_id_index::version;
+    header.block_size      = block_size;
+    header.load_order_hash = load_order_hash;
+    header.entry_count     = static_cast<uint32_t>(entries.size());
+    header.block_count     = static_cast<uint32_t>(heads.size());
+    header.heads_offset    = sizeof(Header);
+    header.blocks_offset   = header.heads_offset + header.block_count * sizeof(Head);
+    header.blocks_size     = static_cast<uint32_t>(blocks.size());
+    if (uint64_t{header.blocks_offset} + blocks.size() > UINT32_MAX) {
+        error_ = "too many editor IDs for one index";
+        return false;
+    }
+
+    // Written beside the old index and moved over it, so a failed build never leaves half a file
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(heads.data()), heads.size() * sizeof(Head));
+        out.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+        if (!out.flush()) {
+            error_ = "cannot write " + temporary.string();
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        error_ = "cannot replace " + path.string();
+        return false;
+    }
+    return open(path);
+}
+
+int EditorIdIndex::compare_head(
+    const Head& head, const Prefix& prefix, std::string_view key
+) const {
+    if (head.prefix != prefix) return head.prefix < prefix ? -1 : 1;
+    if (head.key_length <= prefix_length && key.size() <= prefix_length)
+        return head.key_length == key.size() ? 0 : head.key_length < key.size() ? -1 : 1;
+
+    // Same first 16 bytes: compare the whole first key of the block
+    auto* first = reinterpret_cast<const char*>(blocks_ + head.offset + 2);
+    return std::string_view(first, head.key_length).compare(key);
+}
+
+uint32_t EditorIdIndex::find(std::string_view editor_id) const {
+    using editor_id_index::max_key_length;
+    if (!heads_ || editor_id.empty() || editor_id.size() > max_key_length) return 0;
+
+    char folded[max_key_length];
+    for (size_t i = 0; i < editor_id.size(); i++) folded[i] = fold(editor_id[i]);
+    std::string_view key(folded, editor_id.size());
+    Prefix           prefix(key);
+
+    // The last head at or before the key starts the only block that can hold it; that is the
+    // last node the descent went right from
+    size_t k     = 1;
+    size_t floor = 0;
+    while (k <= block_count_) {
+        bool right = compare_head(heads_[k - 1], prefix, key) <= 0;
+        floor      = right ? k : floor;
+        k          = 2 * k + right;
+    }
+    if (floor == 0) return 0;
+    const Head& head = heads_[floor - 1];
+
+    // Keys are compared in place: `matched` is how much of the key the previous entry matched,
+    // so an entry sharing more than that with it sorts before the key just like it did, and one
+    // sharing less sorts after the key
+    const uint8_t* entry   = blocks_ + head.offset;
+    const uint8_t* end     = entry + head.size;
+    size_t         matched = 0;
+    size_t         length  = 0;
+    for (size_t i = 0; i < head.count; i++) {
+        if (end - entry < 2) return 0;
+        size_t shared = entry[0];
+        size_t suffix = entry[1];
+        entry += 2;
+        if (shared > length || static_cast<size_t>(end - entry) < suffix + sizeof(uint32_t))
+            return 0;  // damaged block
+        const uint8_t* bytes = entry;
+        entry += suffix;
+        length = shared + suffix;
+
+        if (shared < matched) return 0;
+        if (shared == matched) {
+            size_t same = 0;
+            while (same < suffix && matched + same < key.size() &&
+                   bytes[same] == static_cast<uint8_t>(key[matched + same]))
+                same++;
+            matched += same;
+            if (same == suffix && matched == key.size()) {
+                uint32_t form_id;
+                memcpy(&form_id, entry, sizeof(form_id));
+                return form_id;
+            }
+            if (same < suffix &&
+                (matched == key.size() || bytes[same] > static_cast<uint8_t>(key[matched])))
+                return 0;  // sorts after the key
+        }
+        entry += sizeof(uint32_t);
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mapped_file.h"
+
+// Editor ID index file layout (all integers little-endian)
+//
+//   header:  "JSEI" u16 version u16 block_size u64 load_order_hash u32 entry_count
+//            u32 block_count u32 heads_offset u32 blocks_offset u32 blocks_size u32 reserved
+//   heads:   block_count * {u64 prefix[2], u32 offset, u16 size, u8 key_length, u8 count},
+//            in Eytzinger order
+//   blocks:  block_size entries each (fewer in the last block), sorted by lowercased editor ID:
+//            u8 shared, u8 suffix_length, <suffix bytes>, u32 form_id
+//
+// Each entry's key is the first `shared` bytes of the previous key in its block followed by its
+// suffix; the first key of a block is stored whole. A head holds the first 16 bytes of the first
+// key of its block as big-endian integers, so a search over the heads mostly compares integers
+// and touches one block.
+namespace editor_id_index {
+    constexpr char     magic[4]       = {'J', 'S', 'E', 'I'};
+    constexpr uint16_t version        = 1;
+    constexpr uint16_t block_size     = 16;
+    constexpr size_t   max_key_length = 255;  // longer editor IDs are left out of the index
+}
+
+struct EditorIdEntry {
+    std::string editor_id;
+    uint32_t    form_id = 0;
+};
+
+// Fingerprint of a load order: its plugin files, in order, with their sizes and write times
+class LoadOrderHash {
+public:
+    void add_file(std::string_view name, uint64_t size, int64_t modified);
+
+    uint64_t value() const { return hash_; }
+
+private:
+    void add(const void* data, size_t size);
+
+    uint64_t hash_ = 14695981039346656037ull;  // FNV-1a
+};
+
+// Read-only, memory-mapped editor ID -> FormID index
+//
+// build() writes the index for one load order and opens it; later launches open() the same file
+// and reuse it while load_order_hash() still matches. Opening checks the layout but reads no
+// entries, and find() reads the heads and one block in place, so lookups never allocate.
+// Editor IDs are matched case-insensitively (ASCII). Not thread-safe; the owner serializes
+// access.
+class EditorIdIndex {
+public:
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    // Writes the index to `path` (replacing any file there) and opens it
+    bool build(
+        const std::filesystem::path& path, uint64_t load_order_hash,
+        std::vector<EditorIdEntry> entries
+    );
+
+    // 0 when the index has no such editor ID
+    uint32_t find(std::string_view editor_id) const;
+
+    bool               is_open() const { return heads_ != nullptr; }
+    size_t             size() const { return entry_count_; }
+    uint64_t           load_order_hash() const { return load_order_hash_; }
+    const std::string& error() const { return error_; }
+
+private:
+    struct Prefix;
+    struct Head;
+
+    int compare_head(const Head& head, const Prefix& prefix, std::string_view key) const;
+
+    MappedFile     file_;
+    const Head*    heads_           = nullptr;
+    const uint8_t* blocks_          = nullptr;
+    size_t         entry_count_     = 0;
+    size_t         block_count_     = 0;
+    uint64_t       load_order_hash_ = 0;
+    std::string    error_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <array>
+#include <format>
+#include <string_view>
+#include <type_traits>
+
+#include "binary_log.h"
+
+// Writer used while binary logging is enabled (see the `jslog` console command)
+inline BinaryLogWriter& binary_log_writer() {
+    static BinaryLogWriter writer;
+    return writer;
+}
+
+template <class T>
+binary_log::Arg to_binary_log_arg(const T& value) {
+    if constexpr (std::is_same_v<T, bool>) return value;
+    else if constexpr (std::is_integral_v<T>) return static_cast<int64_t>(value);
+    else if constexpr (std::is_floating_point_v<T>) return static_cast<double>(value);
+    else return std::string_view{value};
+}
+
+// Logs a native event, either as fmt-formatted text or, in binary mode, as the raw arguments
+// plus an interned format id so that formatting happens in the offline decoder instead.
+template <class... Args>
+void log_event(std::format_string<const Args&...> format, const Args&... args) {
+    auto& writer = binary_log_writer();
+    if (writer.is_open()) {
+        std::array<binary_log::Arg, sizeof...(Args)> binary_args{to_binary_log_arg(args)...};
+        writer.write_event(writer.intern_format(format.get()), binary_args);
+    } else {
+        Log("{}", std::format(format, args...));
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct FormCacheStats {
+    uint64_t hits   = 0;
+    uint64_t misses = 0;  // resolved through the lookup functions
+};
+
+// Memoized form lookups: FormID -> form and editor ID -> FormID (and form)
+//
+// Misses go to the lookup functions (the game's form tables in the plugin, a stand-in database
+// in form-bench), and both found and missing forms are remembered until clear(), which must run
+// whenever the set of forms changes (a game load). Forms in the dynamic range (0xFF......) are
+// created and deleted while a game runs, so they are never cached. Editor IDs are matched
+// case-insensitively without allocating. Not thread-safe; the owner serializes access.
+template <class Form>
+class FormCache {
+public:
+    using FindById       = Form* (*)(uint32_t form_id);
+    using FindByEditorId = uint32_t (*)(std::string_view editor_id);  // 0 when there is none
+
+    FormCache(FindById find_by_id, FindByEditorId find_by_editor_id)
+        : find_by_id_(find_by_id), find_by_editor_id_(find_by_editor_id) {}
+
+    // nullptr when there is no such form
+    Form* get(uint32_t form_id) {
+        if (form_id == 0) return nullptr;
+        if (is_dynamic(form_id)) {
+            stats_.misses++;
+            return find_by_id_(form_id);
+        }
+        if (auto found = forms_.find(form_id); found != forms_.end()) {
+            stats_.hits++;
+            return found->second;
+        }
+        stats_.misses++;
+        return forms_.emplace(form_id, find_by_id_(form_id)).first->second;
+    }
+
+    // 0 when no form has this editor ID
+    uint32_t form_id(std::string_view editor_id) { return find_editor_id(editor_id).form_id; }
+
+    Form* by_editor_id(std::string_view editor_id) {
+        auto named = find_editor_id(editor_id);
+        return is_dynamic(named.form_id) ? find_by_id_(named.form_id) : named.form;
+    }
+
+    void clear() {
+        forms_.clear();
+        editor_ids_.clear();
+    }
+
+    size_t                size() const { return forms_.size() + editor_ids_.size(); }
+    const FormCacheStats& stats() const { return stats_; }
+
+private:
+    struct Named {
+        uint32_t form_id = 0;
+        Form*    form    = nullptr;  // for forms outside the dynamic range
+    };
+
+    static bool is_dynamic(uint32_t form_id) { return (form_id >> 24) == 0xFF; }
+
+    // ASCII case folding; editor IDs are ASCII and this is much cheaper than tolower
+    static unsigned char fold(char c) {
+        return static_cast<unsigned char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    }
+
+    Named find_editor_id(std::string_view editor_id) {
+        if (auto found = editor_ids_.find(editor_id); found != editor_ids_.end()) {
+            stats_.hits++;
+            return found->second;
+        }
+        stats_.misses++;
+        Named named{find_by_editor_id_(editor_id)};
+        if (is_dynamic(named.form_id)) return named;
+        named.form = named.form_id ? get(named.form_id) : nullptr;
+        editor_ids_.emplace(editor_id, named);
+        return named;
+    }
+
+    struct CaseInsensitiveHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const {
+            size_t hash = 14695981039346656037ull;  // FNV-1a
+            for (char c : s) hash = (hash ^ fold(c)) * 1099511628211ull;
+            return hash;
+        }
+    };
+
+    struct CaseInsensitiveEqual {
+        using is_transparent = void;
+        bool operator()(std::string_view a, std::string_view b) const {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); i++) {
+                if (fold(a[i]) != fold(b[i])) return false;
+            }
+            return true;
+        }
+    };
+
+    FindById                                 find_by_id_;
+    FindByEditorId                           find_by_editor_id_;
+    std::unordered_map<uint32_t, Form*>      forms_;  // nullptr for IDs known not to exist
+    std::unordered_map<std::string, Named, CaseInsensitiveHash, CaseInsensitiveEqual>
+                   editor_ids_;  // form ID 0 for editor IDs known not to exist
+    FormCacheStats stats_;
+};
@@ -0,0 +1,32 @@
+#include "frame_pump.h"
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <atomic>
+#include <vector>
+
+namespace {
+    std::vector<FramePumpStep>& steps() {
+        static std::vector<FramePumpStep> instance;
+        return instance;
+    }
+
+    std::atomic<bool> pump_pending = false;
+
+    void run_frame_pump() {
+        // Cleared first so that work queued by a step schedules the next frame's pump
+        pump_pending = false;
+        for (auto step : steps()) step();
+    }
+}
+
+void add_frame_pump_step(FramePumpStep step) { steps().push_back(step); }
+
+void request_frame_pump() {
+    if (pump_pending.exchange(true)) return;
+    if (auto* tasks = SKSE::GetTaskInterface()) {
+        tasks->AddTask(run_frame_pump);
+    } else {
+        pump_pending = false;
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Runs native work on the main thread once per frame, only in frames where something asked for
+// it. Any thread may call request_frame_pump(); requests made before the pump runs coalesce into
+// a single SKSE task, so work queued from many calls in one frame is handled in one batch.
+
+using FramePumpStep = void (*)();
+
+// Steps run in registration order on every pump
+void add_frame_pump_step(FramePumpStep step);
+
+// Schedules a pump for the next frame unless one is already pending
+void request_frame_pump();
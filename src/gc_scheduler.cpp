@@ -0,0 +1,89 @@
+#include "gc_scheduler.h"
+
+#include <algorithm>
+
+#include "js_entry.h"
+
+GcSchedulerSettings GcSchedulerSettings::from_ini(const IniFile& ini) {
+    GcSchedulerSettings settings;
+    if (auto mb = ini.get_number("gc", "gameplay_threshold_mb"); mb && *mb > 0)
+        settings.gameplay_threshold = static_cast<size_t>(*mb * 1024 * 1024);
+    if (auto kb = ini.get_number("gc", "idle_threshold_kb"); kb && *kb > 0)
+        settings.idle_threshold = static_cast<size_t>(*kb * 1024);
+    if (auto mb = ini.get_number("gc", "frame_growth_mb"); mb && *mb >= 0)
+        settings.frame_growth = static_cast<size_t>(*mb * 1024 * 1024);
+    return settings;
+}
+
+void GcScheduler::attach(JSRuntime* rt, GameActivity activity, const size_t* heap_bytes) {
+    runtime_         = rt;
+    activity_        = activity;
+    heap_bytes_      = heap_bytes;
+    heap_floor_      = heap_bytes ? *heap_bytes : 0;
+    collection_owed_ = false;
+    apply_threshold();
+}
+
+void GcScheduler::set_activity(GameActivity activity) {
+    JSEntryLock lock;
+    if (activity == activity_) return;
+    activity_        = activity;
+    collection_owed_ = activity != GameActivity::Gameplay;
+    if (!runtime_) return;
+    lock.enter(runtime_);
+    apply_threshold();
+}
+
+void GcScheduler::set_settings(const GcSchedulerSettings& settings) {
+    JSEntryLock lock;
+    settings_ = settings;
+    if (runtime_) apply_threshold();
+}
+
+bool GcScheduler::collection_due() const {
+    if (!runtime_) return false;
+    if (collection_owed_) return true;
+    return activity_ == GameActivity::Gameplay && heap_bytes_ && settings_.frame_growth > 0 &&
+           *heap_bytes_ >= std::min(heap_floor_, *heap_bytes_) + settings_.frame_growth;
+}
+
+void GcScheduler::on_frame() {
+    JSEntryLock lock;
+    if (!runtime_) return;
+    lock.enter(runtime_);
+    if (heap_bytes_) heap_floor_ = std::min(heap_floor_, *heap_bytes_);  // QuickJS collected
+    if (!collection_due()) {
+        apply_threshold();
+        return;
+    }
+
+    if (!collection_owed_) metrics_.frame_collections++;
+    else if (activity_ == GameActivity::Menu) metrics_.menu_collections++;
+    else if (activity_ == GameActivity::Loading) metrics_.loading_collections++;
+    collection_owed_ = false;
+    collect();
+}
+
+void GcScheduler::collect() {
+    // Finalizers run during the collection and touch the runtime's native state
+    JSEntryLock lock;
+    if (!runtime_) return;
+    lock.enter(runtime_);
+
+    auto start = std::chrono::steady_clock::now();
+    JS_RunGC(runtime_);
+    std::chrono::duration<double, std::milli> pause = std::chrono::steady_clock::now() - start;
+
+    metrics_.collections++;
+    metrics_.last_pause_ms = pause.count();
+    metrics_.total_pause_ms += pause.count();
+    metrics_.max_pause_ms = std::max(metrics_.max_pause_ms, pause.count());
+    if (heap_bytes_) heap_floor_ = *heap_bytes_;
+    apply_threshold();
+}
+
+void GcScheduler::apply_threshold() {
+    size_t headroom = activity_ == GameActivity::Gameplay ? settings_.gameplay_threshold
+                                                          : settings_.idle_threshold;
+    JS_SetGCThreshold(runtime_, (heap_bytes_ ? *heap_bytes_ : 0) + headroom);
+}
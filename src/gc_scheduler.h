@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "ini_file.h"
+#include "quickjs.h"
+
+// What the game is doing, as far as GC scheduling is concerned
+enum class GameActivity { Gameplay, Menu, Loading };
+
+// The thresholds are headroom above the live heap: QuickJS collects on its own once that much
+// more has been allocated
+struct GcSchedulerSettings {
+    size_t gameplay_threshold = 16 * 1024 * 1024;  // let garbage pile up while the game runs
+    size_t idle_threshold     = 256 * 1024;        // QuickJS's default, used in menus
+    size_t frame_growth       = 4 * 1024 * 1024;   // heap growth collected between frames, 0 = off
+
+    // Reads the [gc] section, keeping the defaults for missing keys
+    static GcSchedulerSettings from_ini(const IniFile& ini);
+};
+
+struct GcMetrics {
+    uint64_t collections         = 0;
+    uint64_t menu_collections    = 0;
+    uint64_t loading_collections = 0;
+    uint64_t frame_collections   = 0;
+    double   total_pause_ms      = 0;
+    double   max_pause_ms        = 0;
+    double   last_pause_ms       = 0;
+};
+
+// Moves QuickJS garbage collection out of gameplay
+//
+// While the game is running the GC threshold is raised so the allocator rarely trips a
+// collection mid-frame, and the threshold drops back down in menus and loading screens. The
+// deliberate collections run from the frame pump, between frames: one on entering a menu or
+// loading screen, and one whenever the heap has grown by frame_growth during gameplay, before
+// QuickJS's own threshold would trip inside a script. Only the deliberate collections are
+// timed, since QuickJS has no hook around the collections it triggers itself. Those reset the
+// runtime's threshold to 1.5x the heap, so every frame and collection sets it back to the
+// activity's headroom above the live heap.
+//
+// Callable from any thread: changes that reach the runtime hold the JSEntryLock.
+class GcScheduler {
+public:
+    GcScheduler() = default;
+    explicit GcScheduler(const GcSchedulerSettings& settings) : settings_(settings) {}
+
+    // `heap_bytes` is the runtime's live heap size (its allocator's bytes_in_use); without it
+    // there are no collections for growth during gameplay
+    void attach(JSRuntime* rt, GameActivity activity, const size_t* heap_bytes = nullptr);
+    void detach() { runtime_ = nullptr; }
+
+    // Leaving gameplay makes the next frame pump collect
+    void set_activity(GameActivity activity);
+    void set_settings(const GcSchedulerSettings& settings);
+
+    // Whether on_frame() would collect now
+    bool collection_due() const;
+
+    // Frame pump step, once per frame: runs the collection that is due, if any, and restores
+    // the threshold
+    void on_frame();
+
+    // Runs a timed JS_RunGC now
+    void collect();
+
+    GameActivity               activity() const { return activity_; }
+    const GcMetrics&           metrics() const { return metrics_; }
+    const GcSchedulerSettings& settings() const { return settings_; }
+
+private:
+    void apply_threshold();
+
+    JSRuntime*          runtime_         = nullptr;
+    const size_t*       heap_bytes_      = nullptr;
+    size_t              heap_floor_      = 0;  // lowest heap size since the last collection
+    GameActivity        activity_        = GameActivity::Gameplay;
+    bool                collection_owed_ = false;  // for entering a menu or loading screen
+    GcSchedulerSettings settings_;
+    GcMetrics           metrics_;
+};
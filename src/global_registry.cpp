@@ -0,0 +1,84 @@
+#include "global_registry.h"
+
+#include <cassert>
+
+namespace {
+    // Whether two values are the same JS value without running any JS (no conversions)
+    bool same_value(JSValueConst a, JSValueConst b) {
+        if (JS_VALUE_GET_TAG(a) != JS_VALUE_GET_TAG(b)) return false;
+        if (JS_VALUE_HAS_REF_COUNT(a)) return JS_VALUE_GET_PTR(a) == JS_VALUE_GET_PTR(b);
+        if (JS_IsUndefined(a) || JS_IsNull(a)) return true;
+        if (JS_IsBool(a)) return JS_VALUE_GET_BOOL(a) == JS_VALUE_GET_BOOL(b);
+        if (JS_VALUE_GET_TAG(a) == JS_TAG_INT) return JS_VALUE_GET_INT(a) == JS_VALUE_GET_INT(b);
+        return false;
+    }
+}
+
+GlobalRegistry::~GlobalRegistry() {
+    // Entries can only be released with their context; clear() must have run first
+    assert(entries_.empty());
+}
+
+std::optional<JSValue> GlobalRegistry::find(JSContext* ctx, std::string_view name) {
+    auto it = index_.find(name);
+    if (it == index_.end()) return std::nullopt;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return JS_DupValue(ctx, it->second->value);
+}
+
+JSValue GlobalRegistry::materialize(JSContext* ctx, std::string_view name, JSValue value) {
+    if (auto it = index_.find(name); it != index_.end()) {
+        JS_FreeValue(ctx, it->second->value);
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    entries_.push_front({std::string(name), JS_DupValue(ctx, value)});
+    index_.emplace(entries_.front().name, entries_.begin());
+
+    // Define on globalThis so it persists
+    JSValue global_obj = JS_GetGlobalObject(ctx);
+    JS_SetPropertyStr(ctx, global_obj, entries_.front().name.c_str(), JS_DupValue(ctx, value));
+    JS_FreeValue(ctx, global_obj);
+
+    evict_to_capacity(ctx);
+    return value;
+}
+
+void GlobalRegistry::set_capacity(JSContext* ctx, size_t capacity) {
+    capacity_ = capacity > 0 ? capacity : default_capacity;
+    evict_to_capacity(ctx);
+}
+
+void GlobalRegistry::evict_to_capacity(JSContext* ctx) {
+    if (entries_.size() <= capacity_) return;
+
+    JSValue global_obj = JS_GetGlobalObject(ctx);
+    while (entries_.size() > capacity_) {
+        Entry& entry = entries_.back();
+
+        JSAtom  atom    = JS_NewAtomLen(ctx, entry.name.data(), entry.name.size());
+        JSValue current = JS_GetProperty(ctx, global_obj, atom);
+        if (same_value(current, entry.value)) JS_DeleteProperty(ctx, global_obj, atom, 0);
+        JS_FreeValue(ctx, current);
+        JS_FreeAtom(ctx, atom);
+
+        JS_FreeValue(ctx, entry.value);
+        index_.erase(entry.name);
+        entries_.pop_back();
+    }
+    JS_FreeValue(ctx, global_obj);
+}
+
+void GlobalRegistry::clear(JSContext* ctx) {
+    for (auto& entry : entries_) JS_FreeValue(ctx, entry.value);
+    entries_.clear();
+    index_.clear();
+}
+
+size_t GlobalRegistry::approximate_bytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : entries_)
+        bytes += sizeof(Entry) + entry.name.capacity() + 4 * sizeof(void*);  // list + map nodes
+    return bytes;
+}
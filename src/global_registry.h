@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "quickjs.h"
+
+// Resolves an unknown global name for js_lookup_global: a new reference to its value, or
+// std::nullopt to leave the name to the next resolver
+using GlobalResolver = std::optional<JSValue> (*)(JSContext* ctx, std::string_view name);
+
+// Lazily materialized globals of one context (see js_lookup_global)
+//
+// Holds a reference to each value it hands out, so it must be cleared with the owning context
+// before JS_FreeContext. Once more than `capacity` entries exist the least recently looked-up
+// one is evicted: its reference is released and, if globalThis still holds the same value, the
+// global is deleted again so the next access re-materializes it through the lookup proxy.
+class GlobalRegistry {
+public:
+    static constexpr size_t default_capacity = 4096;
+
+    GlobalRegistry() = default;
+    GlobalRegistry(const GlobalRegistry&)            = delete;
+    GlobalRegistry& operator=(const GlobalRegistry&) = delete;
+    ~GlobalRegistry();
+
+    // Returns a new reference to the global, marking it most recently used
+    std::optional<JSValue> find(JSContext* ctx, std::string_view name);
+
+    // Takes ownership of `value`, stores it, defines it on globalThis and returns it
+    JSValue materialize(JSContext* ctx, std::string_view name, JSValue value);
+
+    void set_capacity(JSContext* ctx, size_t capacity);
+    void clear(JSContext* ctx);
+
+    size_t size() const { return index_.size(); }
+    size_t capacity() const { return capacity_; }
+    size_t approximate_bytes() const;
+
+private:
+    struct Entry {
+        std::string name;
+        JSValue     value;
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    void evict_to_capacity(JSContext* ctx);
+
+    std::list<Entry> entries_;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator, StringHash, std::equal_to<>>
+           index_;
+    size_t capacity_ = default_capacity;
+};
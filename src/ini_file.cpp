@@ -0,0 +1,83 @@
+#include "ini_file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    std::string_view trim(std::string_view s) {
+        while (!s.empty() && isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+        while (!s.empty() && isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+        return s;
+    }
+
+    std::string lowercase(std::string_view s) {
+        std::string out(s);
+        for (auto& c : out) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return out;
+    }
+}
+
+bool IniFile::load(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::stringstream text;
+    text << file.rdbuf();
+    parse(text.str());
+    return true;
+}
+
+void IniFile::parse(std::string_view text) {
+    std::string section;
+
+    while (!text.empty()) {
+        size_t           eol  = text.find('\n');
+        std::string_view line = trim(text.substr(0, eol));
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+
+        if (line.empty() || line.front() == ';' || line.front() == '#') continue;
+
+        if (line.front() == '[') {
+            size_t close = line.find(']');
+            if (close == line.npos) close = line.size();
+            section = lowercase(trim(line.substr(1, close - 1)));
+            if (!has_section(section)) sections_.push_back(section);
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == line.npos) continue;
+
+        std::string_view value = trim(line.substr(equals + 1));
+        if (size_t comment = value.find_first_of(";#"); comment != value.npos)
+            value = trim(value.substr(0, comment));
+
+        values_[make_key(section, trim(line.substr(0, equals)))] = std::string(value);
+    }
+}
+
+bool IniFile::has_section(std::string_view section) const {
+    return std::ranges::find(sections_, lowercase(section)) != sections_.end();
+}
+
+std::optional<std::string_view> IniFile::get(std::string_view section, std::string_view key) const {
+    auto it = values_.find(make_key(section, key));
+    if (it == values_.end()) return std::nullopt;
+    return it->second;
+}
+
+std::optional<double> IniFile::get_number(std::string_view section, std::string_view key) const {
+    auto value = get(section, key);
+    if (!value) return std::nullopt;
+
+    double number = 0;
+    auto [end, error] = std::from_chars(value->data(), value->data() + value->size(), number);
+    if (error != std::errc{} || end != value->data() + value->size()) return std::nullopt;
+    return number;
+}
+
+std::string IniFile::make_key(std::string_view section, std::string_view key) {
+    return lowercase(section) + '\n' + lowercase(key);
+}
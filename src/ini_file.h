@@ -0,0 +1,31 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Minimal INI reader: [section] headers, key = value pairs, ';' or '#' comments
+//
+// Section and key names are case-insensitive. Keys before the first section belong to "".
+class IniFile {
+public:
+    bool load(const std::filesystem::path& path);
+    void parse(std::string_view text);
+
+    bool has_section(std::string_view section) const;
+
+    // Lowercased section names, in the order they first appear
+    const std::vector<std::string>& sections() const { return sections_; }
+
+    std::optional<std::string_view> get(std::string_view section, std::string_view key) const;
+    std::optional<double>           get_number(std::string_view section, std::string_view key) const;
+
+private:
+    static std::string make_key(std::string_view section, std::string_view key);
+
+    std::unordered_map<std::string, std::string> values_;  // "section\nkey" -> value
+    std::vector<std::string>                     sections_;
+};
@@ -0,0 +1,146 @@
+#include "js_allocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+    constexpr uint32_t large_size_class = UINT32_MAX;
+    constexpr auto     block_alignment  = std::align_val_t{16};
+
+    struct alignas(16) BlockHeader {
+        uint32_t size_class;
+        uint32_t reserved;
+        size_t   size;  // usable size of the block
+    };
+    static_assert(sizeof(BlockHeader) == 16);
+
+    BlockHeader* header_of(const void* ptr) {
+        return const_cast<BlockHeader*>(static_cast<const BlockHeader*>(ptr) - 1);
+    }
+
+    void* payload_of(BlockHeader* header) { return header + 1; }
+}
+
+PooledJSAllocator::PooledJSAllocator() {
+    malloc_functions_.js_calloc = [](void* opaque, size_t count, size_t size) -> void* {
+        if (size != 0 && count > SIZE_MAX / size) return nullptr;
+        void* ptr = static_cast<PooledJSAllocator*>(opaque)->allocate(count * size);
+        if (ptr) memset(ptr, 0, count * size);
+        return ptr;
+    };
+    malloc_functions_.js_malloc = [](void* opaque, size_t size) -> void* {
+        return static_cast<PooledJSAllocator*>(opaque)->allocate(size);
+    };
+    malloc_functions_.js_free = [](void* opaque, void* ptr) {
+        static_cast<PooledJSAllocator*>(opaque)->deallocate(ptr);
+    };
+    malloc_functions_.js_realloc = [](void* opaque, void* ptr, size_t size) -> void* {
+        return static_cast<PooledJSAllocator*>(opaque)->reallocate(ptr, size);
+    };
+    malloc_functions_.js_malloc_usable_size = [](const void* ptr) -> size_t {
+        return ptr ? PooledJSAllocator::usable_size(ptr) : 0;
+    };
+}
+
+PooledJSAllocator::~PooledJSAllocator() {
+    for (void* slab : slabs_) ::operator delete(slab, block_alignment);
+}
+
+void* PooledJSAllocator::allocate(size_t size) {
+    if (size == 0) size = 1;
+
+    void* ptr = size <= max_small_size ? allocate_small((size - 1) / size_class_step)
+                                       : allocate_large(size);
+    if (!ptr) return nullptr;
+
+    size_t usable = usable_size(ptr);
+    stats_.bytes_in_use += usable;
+    stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    stats_.live_allocations++;
+    stats_.total_allocations++;
+    return ptr;
+}
+
+void* PooledJSAllocator::allocate_small(size_t size_class) {
+    auto& pool = size_classes_[size_class];
+
+    if (pool.free_list) {
+        FreeBlock* block = pool.free_list;
+        pool.free_list   = block->next;
+        return block;
+    }
+
+    size_t block_size = sizeof(BlockHeader) + (size_class + 1) * size_class_step;
+    if (static_cast<size_t>(pool.end - pool.cursor) < block_size) {
+        auto* slab =
+            static_cast<uint8_t*>(::operator new(slab_size, block_alignment, std::nothrow));
+        if (!slab) return nullptr;
+        slabs_.push_back(slab);
+        stats_.slab_bytes += slab_size;
+        pool.cursor = slab;
+        pool.end    = slab + slab_size;
+    }
+
+    auto* header = reinterpret_cast<BlockHeader*>(pool.cursor);
+    pool.cursor += block_size;
+    header->size_class = static_cast<uint32_t>(size_class);
+    header->reserved   = 0;
+    header->size       = (size_class + 1) * size_class_step;
+    return payload_of(header);
+}
+
+void* PooledJSAllocator::allocate_large(size_t size) {
+    if (size > SIZE_MAX - sizeof(BlockHeader)) return nullptr;
+    auto* header = static_cast<BlockHeader*>(
+        ::operator new(sizeof(BlockHeader) + size, block_alignment, std::nothrow)
+    );
+    if (!header) return nullptr;
+    header->size_class = large_size_class;
+    header->reserved   = 0;
+    header->size       = size;
+    stats_.large_bytes += size;
+    stats_.large_allocations++;
+    return payload_of(header);
+}
+
+void PooledJSAllocator::deallocate(void* ptr) {
+    if (!ptr) return;
+
+    BlockHeader* header = header_of(ptr);
+    stats_.bytes_in_use -= header->size;
+    stats_.live_allocations--;
+
+    if (header->size_class == large_size_class) {
+        stats_.large_bytes -= header->size;
+        ::operator delete(header, block_alignment);
+        return;
+    }
+
+    // The header stays intact while the block sits on the free list
+    auto& pool     = size_classes_[header->size_class];
+    auto* block    = static_cast<FreeBlock*>(ptr);
+    block->next    = pool.free_list;
+    pool.free_list = block;
+}
+
+void* PooledJSAllocator::reallocate(void* ptr, size_t size) {
+    if (!ptr) return allocate(size);
+    if (size == 0) {
+        deallocate(ptr);
+        return nullptr;
+    }
+
+    size_t old_size = usable_size(ptr);
+
+    // Shrinking, or growing within the block's size class, keeps the block in place
+    if (size <= old_size && (old_size <= max_small_size || size > max_small_size)) return ptr;
+
+    void* resized = allocate(size);
+    if (!resized) return nullptr;
+    memcpy(resized, ptr, std::min(old_size, size));
+    deallocate(ptr);
+    return resized;
+}
+
+size_t PooledJSAllocator::usable_size(const void* ptr) { return header_of(ptr)->size; }
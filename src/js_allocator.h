@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "quickjs.h"
+
+struct JSAllocatorStats {
+    size_t bytes_in_use      = 0;  // usable bytes handed out to QuickJS
+    size_t peak_bytes_in_use = 0;
+    size_t slab_bytes        = 0;  // memory reserved for size-class slabs
+    size_t large_bytes       = 0;  // memory in fallback (non-pooled) allocations
+    size_t live_allocations  = 0;
+    size_t total_allocations = 0;
+    size_t large_allocations = 0;
+};
+
+// Size-class pool allocator backing a single JSRuntime (via JS_NewRuntime2)
+//
+// Small blocks are carved out of per-size-class slabs and recycled through intrusive free
+// lists; anything above max_small_size goes to the system heap. Every block carries a 16-byte
+// header so js_malloc_usable_size can be answered without the allocator instance.
+//
+// Not thread-safe: a JSRuntime is only ever used from one thread at a time. The allocator must
+// outlive the runtime (JS_FreeRuntime frees the runtime itself through it) and destroying it
+// releases every slab at once.
+class PooledJSAllocator {
+public:
+    static constexpr size_t size_class_step  = 16;
+    static constexpr size_t max_small_size   = 512;
+    static constexpr size_t size_class_count = max_small_size / size_class_step;
+    static constexpr size_t slab_size        = 64 * 1024;
+
+    PooledJSAllocator();
+    ~PooledJSAllocator();
+
+    PooledJSAllocator(const PooledJSAllocator&)            = delete;
+    PooledJSAllocator& operator=(const PooledJSAllocator&) = delete;
+
+    const JSMallocFunctions& malloc_functions() const { return malloc_functions_; }
+    const JSAllocatorStats&  stats() const { return stats_; }
+
+    void*         allocate(size_t size);
+    void          deallocate(void* ptr);
+    void*         reallocate(void* ptr, size_t size);
+    static size_t usable_size(const void* ptr);
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        FreeBlock* free_list = nullptr;
+        uint8_t*   cursor    = nullptr;  // bump pointer into the newest slab
+        uint8_t*   end       = nullptr;
+    };
+
+    void* allocate_small(size_t size_class);
+    void* allocate_large(size_t size);
+
+    JSMallocFunctions                       malloc_functions_;
+    std::array<SizeClass, size_class_count> size_classes_;
+    std::vector<void*>                      slabs_;
+    JSAllocatorStats                        stats_;
+};
@@ -0,0 +1,23 @@
+#include "js_atoms.h"
+
+#include "runtime_state.h"
+
+void JSAtomTable::init(JSContext* ctx) {
+    if (ready_) return;
+    for (size_t i = 0; i < js_atom_count; i++) atoms_[i] = JS_NewAtom(ctx, js_atom_names[i]);
+    ready_ = true;
+}
+
+void JSAtomTable::release(JSRuntime* rt) {
+    if (!ready_) return;
+    for (auto& atom : atoms_) {
+        JS_FreeAtomRT(rt, atom);
+        atom = JS_ATOM_NULL;
+    }
+    ready_ = false;
+}
+
+JSAtom js_atom(JSContext* ctx, JSAtomName name) {
+    auto* state = get_runtime_state(JS_GetRuntime(ctx));
+    return state ? state->atoms[name] : JS_ATOM_NULL;
+}
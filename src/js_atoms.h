@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+#include "quickjs.h"
+
+// Property names that native code reads or writes on hot paths, interned once per runtime
+//
+// JS_GetPropertyStr/JS_SetPropertyStr intern the name on every call; js_get_property and
+// js_set_property use the runtime's ready atom instead. Add a name here to give it an
+// entry in JSAtomName.
+#define JS_HOT_ATOMS(X) \
+    X(length)           \
+    X(formID)           \
+    X(then)             \
+    X(prototype)        \
+    X(name)             \
+    X(type)             \
+    X(line)             \
+    X(op)               \
+    X(args)             \
+    X(x)                \
+    X(y)                \
+    X(z)                \
+    X(count)            \
+    X(formIDs)          \
+    X(flags)
+
+enum class JSAtomName : size_t {
+#define JS_HOT_ATOM_ENUM(name) name,
+    JS_HOT_ATOMS(JS_HOT_ATOM_ENUM)
+#undef JS_HOT_ATOM_ENUM
+};
+
+constexpr const char* js_atom_names[] = {
+#define JS_HOT_ATOM_NAME(name) #name,
+    JS_HOT_ATOMS(JS_HOT_ATOM_NAME)
+#undef JS_HOT_ATOM_NAME
+};
+
+constexpr size_t js_atom_count = std::size(js_atom_names);
+
+// The hot atoms of one runtime, owned by its RuntimeState
+class JSAtomTable {
+public:
+    // Interns every name; atoms belong to the runtime, so any of its contexts will do
+    void init(JSContext* ctx);
+    void release(JSRuntime* rt);  // before JS_FreeRuntime
+
+    bool   ready() const { return ready_; }
+    JSAtom operator[](JSAtomName name) const { return atoms_[static_cast<size_t>(name)]; }
+
+private:
+    std::array<JSAtom, js_atom_count> atoms_{};
+    bool                              ready_ = false;
+};
+
+// The runtime's atom for `name`, or JS_ATOM_NULL when the runtime has no table (host tools)
+JSAtom js_atom(JSContext* ctx, JSAtomName name);
+
+// JS_GetPropertyStr/JS_SetPropertyStr for the hot names
+inline JSValue js_get_property(JSContext* ctx, JSValueConst object, JSAtomName name) {
+    JSAtom atom = js_atom(ctx, name);
+    if (atom == JS_ATOM_NULL)
+        return JS_GetPropertyStr(ctx, object, js_atom_names[static_cast<size_t>(name)]);
+    return JS_GetProperty(ctx, object, atom);
+}
+
+inline int js_set_property(JSContext* ctx, JSValueConst object, JSAtomName name, JSValue value) {
+    JSAtom atom = js_atom(ctx, name);
+    if (atom == JS_ATOM_NULL)
+        return JS_SetPropertyStr(ctx, object, js_atom_names[static_cast<size_t>(name)], value);
+    return JS_SetProperty(ctx, object, atom, value);
+}
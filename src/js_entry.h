@@ -0,0 +1,42 @@
+#pragma once
+
+#include <mutex>
+
+#include "quickjs.h"
+
+// Serializes native entry into the JS runtime
+//
+// The console REPL runs on the main thread while Papyrus natives implemented in JS are called
+// from the VM's threads. Every native path that evaluates or calls JS, runs the GC or reads the
+// runtime's state holds this lock. The outermost entry on a thread also refreshes QuickJS's
+// stack-overflow check for that thread.
+//
+// A context or runtime that another thread may tear down must only be dereferenced once the
+// lock is held: take the lock without a runtime, re-read the pointer, then call enter().
+class JSEntryLock {
+public:
+    JSEntryLock() : lock_(mutex()), outermost_(depth()++ == 0) {}
+    explicit JSEntryLock(JSRuntime* rt) : JSEntryLock() { enter(rt); }
+    ~JSEntryLock() { depth()--; }
+
+    // Refreshes the stack-overflow check for `rt` if this is the thread's outermost entry
+    void enter(JSRuntime* rt) {
+        if (outermost_ && rt) JS_UpdateStackTop(rt);
+    }
+
+    JSEntryLock(const JSEntryLock&)            = delete;
+    JSEntryLock& operator=(const JSEntryLock&) = delete;
+
+private:
+    static std::recursive_mutex& mutex() {
+        static std::recursive_mutex instance;
+        return instance;
+    }
+    static int& depth() {
+        thread_local int instance = 0;
+        return instance;
+    }
+
+    std::unique_lock<std::recursive_mutex> lock_;
+    bool                                   outermost_;
+};
@@ -0,0 +1,125 @@
+#include "js_forms.h"
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include "editor_id_index.h"
+#include "form_cache.h"
+#include "js_marshal_forms.h"
+
+namespace {
+    constexpr auto EDITOR_ID_INDEX_FILE = "Data/SKSE/Plugins/JavaScriptPapyrusExperiment.editorids";
+
+    // Lookups come from the main thread and from Papyrus VM threads running JS natives
+    std::mutex form_cache_mutex;
+
+    // Editor IDs of the load order's forms, guarded by form_cache_mutex
+    EditorIdIndex editor_ids;
+
+    FormCache<RE::TESForm> form_cache(
+        [](uint32_t form_id) { return RE::TESForm::LookupByID(form_id); },
+        [](std::string_view editor_id) -> uint32_t {
+            if (auto form_id = editor_ids.find(editor_id)) return form_id;
+
+            // Not in the index (or no index yet): forms given editor IDs after data load
+            auto* form = RE::TESForm::LookupByEditorID(editor_id);
+            return form ? form->GetFormID() : 0;
+        }
+    );
+
+    bool is_dynamic(uint32_t form_id) { return (form_id >> 24) == 0xFF; }
+
+    // Active plugins, in load order, with their sizes and write times
+    uint64_t current_load_order_hash() {
+        LoadOrderHash hash;
+        auto          add = [&hash](const RE::TESFile* file) {
+            std::error_code size_error, time_error;
+            auto            path     = std::filesystem::path("Data") / file->fileName;
+            auto            size     = std::filesystem::file_size(path, size_error);
+            auto            modified = std::filesystem::last_write_time(path, time_error);
+            hash.add_file(
+                file->fileName, size_error ? 0 : size,
+                time_error ? 0 : modified.time_since_epoch().count()
+            );
+        };
+        auto& files = RE::TESDataHandler::GetSingleton()->compiledFileCollection;
+        for (auto* file : files.files) add(file);
+        for (auto* file : files.smallFiles) add(file);
+        return hash.value();
+    }
+
+    // Every editor ID the game kept, except those of dynamic forms, which differ between games
+    std::vector<EditorIdEntry> collect_editor_ids() {
+        std::vector<EditorIdEntry> entries;
+        auto [forms, lock] = RE::TESForm::GetAllFormsByEditorID();
+        RE::BSReadLockGuard guard{lock};
+        if (!forms) return entries;
+
+        entries.reserve(forms->size());
+        for (auto& [editor_id, form] : *forms) {
+            if (form && !is_dynamic(form->GetFormID()))
+                entries.push_back({editor_id.c_str(), form->GetFormID()});
+        }
+        return entries;
+    }
+}
+
+JSValue form_get(JSContext* ctx, uint32_t form_id) {
+    RE::TESForm* form;
+    {
+        std::lock_guard lock(form_cache_mutex);
+        form = form_cache.get(form_id);
+    }
+    return to_js(ctx, form);
+}
+
+JSValue form_by_editor_id(JSContext* ctx, std::string editor_id) {
+    RE::TESForm* form;
+    {
+        std::lock_guard lock(form_cache_mutex);
+        form = form_cache.by_editor_id(editor_id);
+    }
+    return to_js(ctx, form);
+}
+
+std::optional<JSValue> resolve_form_global(JSContext* ctx, std::string_view name) {
+    RE::TESForm* form;
+    {
+        std::lock_guard lock(form_cache_mutex);
+        form = form_cache.by_editor_id(name);
+    }
+    if (!form) return std::nullopt;
+    return to_js(ctx, form);
+}
+
+void clear_form_cache() {
+    std::lock_guard lock(form_cache_mutex);
+    form_cache.clear();
+}
+
+size_t form_cache_size() {
+    std::lock_guard lock(form_cache_mutex);
+    return form_cache.size();
+}
+
+void load_editor_id_index() {
+    auto     started = std::chrono::steady_clock::now();
+    uint64_t hash    = current_load_order_hash();
+
+    std::lock_guard lock(form_cache_mutex);
+    if (editor_ids.open(EDITOR_ID_INDEX_FILE) && editor_ids.load_order_hash() == hash) {
+        Log("Editor ID index: {} editor IDs from {}", editor_ids.size(), EDITOR_ID_INDEX_FILE);
+        return;
+    }
+
+    if (!editor_ids.build(EDITOR_ID_INDEX_FILE, hash, collect_editor_ids())) {
+        Log("Editor ID index: cannot build {}: {}", EDITOR_ID_INDEX_FILE, editor_ids.error());
+        return;
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started
+    );
+    Log("Editor ID index: built {} editor IDs in {:.1f} ms", editor_ids.size(), elapsed.count());
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "quickjs.h"
+
+// Form: cached form lookups for JS (see FormCache), shared by every context
+
+// Form.get(formID), exposed through js_bind_def<>; null when there is no such form
+JSValue form_get(JSContext* ctx, uint32_t form_id);
+
+// Form.byEditorId(editorID), exposed through js_bind_def<>; null when no form has it
+JSValue form_by_editor_id(JSContext* ctx, std::string editor_id);
+
+// Global resolver for js_lookup_global: an unknown global named like a form's editor ID
+// resolves to that form
+std::optional<JSValue> resolve_form_global(JSContext* ctx, std::string_view name);
+
+// Opens the editor ID index for the current load order, building it first when the load order
+// changed since it was written; call once the game's data is loaded
+void load_editor_id_index();
+
+// Forgets every cached lookup; call when a game is started or loaded
+void   clear_form_cache();
+size_t form_cache_size();
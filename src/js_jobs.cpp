@@ -0,0 +1,21 @@
+#include "js_jobs.h"
+
+#include "event_log.h"
+
+int run_pending_js_jobs(JSRuntime* rt) {
+    int count = 0;
+    for (;;) {
+        JSContext* job_ctx = nullptr;
+        int        status  = JS_ExecutePendingJob(rt, &job_ctx);
+        if (status == 0) break;
+        count++;
+        if (status < 0 && job_ctx) {
+            JSValue     exception = JS_GetException(job_ctx);
+            const char* message   = JS_ToCString(job_ctx, exception);
+            log_event("Unhandled error in promise job: {}", message ? message : "unknown");
+            if (message) JS_FreeCString(job_ctx, message);
+            JS_FreeValue(job_ctx, exception);
+        }
+    }
+    return count;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "quickjs.h"
+
+// Runs queued promise jobs until none are left, logging any that throw; returns how many ran
+int run_pending_js_jobs(JSRuntime* rt);
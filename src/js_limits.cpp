@@ -0,0 +1,93 @@
+#include "js_limits.h"
+
+#include <algorithm>
+
+namespace {
+    void read_limits(const IniFile& ini, std::string_view section, JSLimits& limits) {
+        if (auto mb = ini.get_number(section, "memory_limit_mb"); mb && *mb > 0)
+            limits.memory_limit = static_cast<size_t>(*mb * 1024 * 1024);
+        if (auto kb = ini.get_number(section, "max_stack_kb"); kb && *kb > 0)
+            limits.max_stack_size = static_cast<size_t>(*kb * 1024);
+        if (auto percent = ini.get_number(section, "warning_percent"); percent && *percent > 0)
+            limits.warning_ratio = std::min(*percent, 100.0) / 100.0;
+        if (auto capacity = ini.get_number(section, "global_registry_capacity");
+            capacity && *capacity >= 1)
+            limits.global_registry_capacity = static_cast<size_t>(*capacity);
+    }
+}
+
+JSLimitsConfig JSLimitsConfig::from_ini(const IniFile& ini) {
+    JSLimitsConfig config;
+    read_limits(ini, "limits", config.defaults);
+    if (auto mb = ini.get_number("limits", "total_budget_mb"); mb && *mb > 0)
+        config.total_budget = static_cast<size_t>(*mb * 1024 * 1024);
+
+    constexpr std::string_view context_prefix = "limits.";
+    for (const auto& section : ini.sections()) {
+        if (!section.starts_with(context_prefix)) continue;
+        JSLimits limits = config.defaults;
+        read_limits(ini, section, limits);
+        config.contexts[section.substr(context_prefix.size())] = limits;
+    }
+    return config;
+}
+
+JSLimits JSLimitsConfig::for_context(std::string_view name) const {
+    if (auto it = contexts.find(std::string(name)); it != contexts.end()) return it->second;
+    return defaults;
+}
+
+void apply_js_limits(JSRuntime* rt, const JSLimits& limits) {
+    JS_SetMemoryLimit(rt, limits.memory_limit);
+    JS_SetMaxStackSize(rt, limits.max_stack_size);
+}
+
+std::optional<size_t> JSMemoryBudget::reserve(const std::string& context, size_t requested) {
+    if (total_ == 0) {
+        reservations_[context] = requested;
+        return requested;
+    }
+
+    auto   previous = reservations_.find(context);
+    size_t others   = reserved() - (previous != reservations_.end() ? previous->second : 0);
+    size_t left     = total_ - std::min(total_, others);
+    size_t granted  = requested == 0 ? left : std::min(requested, left);
+    size_t minimum  = requested == 0 ? min_reservation : std::min(requested, min_reservation);
+    if (granted == 0 || granted < minimum) return std::nullopt;
+
+    reservations_[context] = granted;
+    return granted;
+}
+
+size_t JSMemoryBudget::reserved() const {
+    size_t sum = 0;
+    for (const auto& [name, bytes] : reservations_) sum += bytes;
+    return sum;
+}
+
+std::optional<MemoryPressureTracker::Level> MemoryPressureTracker::update(
+    size_t used, const JSLimits& limits, bool out_of_memory
+) {
+    used_            = used;
+    high_water_mark_ = std::max(high_water_mark_, used);
+
+    Level level = Level::Normal;
+    if (out_of_memory || (limits.memory_limit > 0 && used >= limits.memory_limit)) {
+        level = Level::Limit;
+    } else if (limits.memory_limit > 0 && used >= limits.memory_limit * limits.warning_ratio) {
+        level = Level::Warning;
+    }
+
+    bool rising = level > reported_;
+    reported_   = level;
+    if (!rising) return std::nullopt;
+    return level;
+}
+
+const char* to_string(MemoryPressureTracker::Level level) {
+    switch (level) {
+        case MemoryPressureTracker::Level::Warning: return "warning";
+        case MemoryPressureTracker::Level::Limit:   return "limit";
+        default:                                    return "normal";
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "ini_file.h"
+#include "quickjs.h"
+
+struct JSLimits {
+    size_t memory_limit             = 64 * 1024 * 1024;  // 64 MB
+    size_t max_stack_size           = 1024 * 1024;       // 1 MB
+    double warning_ratio            = 0.8;   // fraction of memory_limit that raises a warning
+    size_t global_registry_capacity = 4096;  // lazily materialized globals kept per context
+};
+
+// Limits for each named context, read from the [limits] and [limits.<context>] INI sections:
+//
+//   [limits]
+//   memory_limit_mb = 64
+//   max_stack_kb    = 1024
+//   warning_percent = 80
+//   global_registry_capacity = 4096
+//   total_budget_mb = 256   ; shared by every context, 0 = unlimited
+//
+//   [limits.repl]
+//   memory_limit_mb = 128
+struct JSLimitsConfig {
+    JSLimits                                  defaults;
+    std::unordered_map<std::string, JSLimits> contexts;
+    size_t                                    total_budget = 0;
+
+    static JSLimitsConfig from_ini(const IniFile& ini);
+
+    JSLimits for_context(std::string_view name) const;
+};
+
+void apply_js_limits(JSRuntime* rt, const JSLimits& limits);
+
+// Hands out memory from a fixed budget shared by all contexts
+class JSMemoryBudget {
+public:
+    // Smallest share worth granting: less than this and a context cannot even start
+    static constexpr size_t min_reservation = 1024 * 1024;
+
+    void set_total(size_t total) { total_ = total; }
+
+    // Reserves up to `requested` bytes for `context`, replacing any earlier reservation, and
+    // returns the amount granted (everything when the budget is unlimited). A request for 0
+    // (no limit) gets what is left of a finite budget. Returns nothing, keeping the earlier
+    // reservation, when less than the request or min_reservation is left; 0 is never granted
+    // from a finite budget since JS_SetMemoryLimit would read it as no limit.
+    std::optional<size_t> reserve(const std::string& context, size_t requested);
+    void   release(const std::string& context) { reservations_.erase(context); }
+
+    size_t total() const { return total_; }
+    size_t reserved() const;
+
+private:
+    size_t                                  total_ = 0;
+    std::unordered_map<std::string, size_t> reservations_;
+};
+
+// Judges a context's memory pressure from samples of its current usage
+//
+// Each level is reported once when usage rises into it; once usage falls back below it, the
+// next rise is reported again. The high-water mark is kept as a statistic only.
+class MemoryPressureTracker {
+public:
+    enum class Level { Normal, Warning, Limit };
+
+    // Returns the level when `used` (or an out-of-memory failure) crosses into a level that has
+    // not been reported since usage was last below it
+    std::optional<Level> update(size_t used, const JSLimits& limits, bool out_of_memory);
+
+    // Allows levels to be reported again, e.g. after the limit was raised
+    void rearm() { reported_ = Level::Normal; }
+
+    Level  level() const { return reported_; }
+    size_t used() const { return used_; }
+    size_t high_water_mark() const { return high_water_mark_; }
+
+private:
+    size_t used_            = 0;
+    size_t high_water_mark_ = 0;
+    Level  reported_        = Level::Normal;
+};
+
+const char* to_string(MemoryPressureTracker::Level level);
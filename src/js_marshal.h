@@ -0,0 +1,383 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "js_atoms.h"
+#include "quickjs.h"
+
+// Compile-time conversions between C++ values and JSValue
+//
+// JSConverter<T> provides
+//   static JSValue to_js(JSContext*, const T&)                  (new reference)
+//   static bool    from_js(JSContext*, JSValueConst, T& out)    (false on a type mismatch)
+// and bind<&fn>() turns a plain C++ function into a JSCFunction whose argument and result
+// conversions are all resolved at compile time (js_bind_def<&fn>() does the same for static
+// function tables). Further specializations (forms, typed arrays) live next to the types they
+// convert.
+
+template <class T>
+struct JSConverter;
+
+template <class T>
+JSValue to_js(JSContext* ctx, const T& value) {
+    return JSConverter<std::remove_cvref_t<T>>::to_js(ctx, value);
+}
+
+template <class T>
+bool from_js(JSContext* ctx, JSValueConst value, T& out) {
+    return JSConverter<T>::from_js(ctx, value, out);
+}
+
+template <class T>
+std::optional<T> from_js(JSContext* ctx, JSValueConst value) {
+    T out{};
+    if (!JSConverter<T>::from_js(ctx, value, out)) return std::nullopt;
+    return out;
+}
+
+template <>
+struct JSConverter<bool> {
+    static JSValue to_js(JSContext* ctx, bool value) { return JS_NewBool(ctx, value); }
+    static bool    from_js(JSContext* ctx, JSValueConst value, bool& out) {
+        if (!JS_IsBool(value)) return false;
+        out = JS_VALUE_GET_BOOL(value);
+        return true;
+    }
+};
+
+template <std::integral T>
+    requires(!std::same_as<T, bool>)
+struct JSConverter<T> {
+    static JSValue to_js(JSContext* ctx, T value) {
+        if constexpr (std::is_signed_v<T> && sizeof(T) <= 4) return JS_NewInt32(ctx, value);
+        else if constexpr (std::is_unsigned_v<T> && sizeof(T) <= 4) return JS_NewUint32(ctx, value);
+        else return JS_NewInt64(ctx, static_cast<int64_t>(value));
+    }
+    static bool from_js(JSContext* ctx, JSValueConst value, T& out) {
+        if (JS_VALUE_GET_TAG(value) == JS_TAG_INT) {
+            out = static_cast<T>(JS_VALUE_GET_INT(value));
+            return true;
+        }
+        if (!JS_IsNumber(value)) return false;
+        if constexpr (std::is_unsigned_v<T> && sizeof(T) <= 4) {
+            uint32_t number;
+            if (JS_ToUint32(ctx, &number, value) != 0) return false;
+            out = static_cast<T>(number);
+        } else {
+            int64_t number;
+            if (JS_ToInt64(ctx, &number, value) != 0) return false;
+            out = static_cast<T>(number);
+        }
+        return true;
+    }
+};
+
+template <std::floating_point T>
+struct JSConverter<T> {
+    static JSValue to_js(JSContext* ctx, T value) { return JS_NewFloat64(ctx, value); }
+    static bool    from_js(JSContext* ctx, JSValueConst value, T& out) {
+        if (JS_VALUE_GET_TAG(value) == JS_TAG_INT) {
+            out = static_cast<T>(JS_VALUE_GET_INT(value));
+            return true;
+        }
+        double number;
+        if (!JS_IsNumber(value) || JS_ToFloat64(ctx, &number, value) != 0) return false;
+        out = static_cast<T>(number);
+        return true;
+    }
+};
+
+template <>
+struct JSConverter<std::string> {
+    static JSValue to_js(JSContext* ctx, const std::string& value) {
+        return JS_NewStringLen(ctx, value.data(), value.size());
+    }
+    static bool from_js(JSContext* ctx, JSValueConst value, std::string& out) {
+        if (!JS_IsString(value)) return false;
+        size_t      len;
+        const char* str = JS_ToCStringLen(ctx, &len, value);
+        if (!str) return false;
+        out.assign(str, len);
+        JS_FreeCString(ctx, str);
+        return true;
+    }
+};
+
+template <>
+struct JSConverter<std::string_view> {
+    static JSValue to_js(JSContext* ctx, std::string_view value) {
+        return JS_NewStringLen(ctx, value.data(), value.size());
+    }
+};
+
+template <>
+struct JSConverter<const char*> {
+    static JSValue to_js(JSContext* ctx, const char* value) {
+        return value ? JS_NewString(ctx, value) : JS_NULL;
+    }
+};
+
+// Passes JS values through untouched: to_js takes ownership, from_js borrows for the call
+template <>
+struct JSConverter<JSValue> {
+    static JSValue to_js(JSContext*, JSValue value) { return value; }
+    static bool    from_js(JSContext*, JSValueConst value, JSValue& out) {
+        out = value;
+        return true;
+    }
+};
+
+// null/undefined <-> std::nullopt
+template <class T>
+struct JSConverter<std::optional<T>> {
+    static JSValue to_js(JSContext* ctx, const std::optional<T>& value) {
+        return value ? JSConverter<T>::to_js(ctx, *value) : JS_NULL;
+    }
+    static bool from_js(JSContext* ctx, JSValueConst value, std::optional<T>& out) {
+        if (JS_IsUndefined(value) || JS_IsNull(value)) {
+            out.reset();
+            return true;
+        }
+        T inner{};
+        if (!JSConverter<T>::from_js(ctx, value, inner)) return false;
+        out = std::move(inner);
+        return true;
+    }
+};
+
+// JS arrays <-> std::vector, element by element (numeric vectors use typed arrays, see below)
+template <class T>
+struct JSConverter<std::vector<T>> {
+    static JSValue to_js(JSContext* ctx, const std::vector<T>& value) {
+        JSValue array = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < value.size(); i++)
+            JS_SetPropertyUint32(ctx, array, i, JSConverter<T>::to_js(ctx, value[i]));
+        return array;
+    }
+    static bool from_js(JSContext* ctx, JSValueConst value, std::vector<T>& out) {
+        if (!JS_IsArray(ctx, value)) return false;
+
+        JSValue  length_value = js_get_property(ctx, value, JSAtomName::length);
+        uint32_t length       = 0;
+        JS_ToUint32(ctx, &length, length_value);
+        JS_FreeValue(ctx, length_value);
+
+        out.clear();
+        out.reserve(length);
+        for (uint32_t i = 0; i < length; i++) {
+            JSValue element = JS_GetPropertyUint32(ctx, value, i);
+            T       item{};
+            bool    ok = JSConverter<T>::from_js(ctx, element, item);
+            JS_FreeValue(ctx, element);
+            if (!ok) return false;
+            out.push_back(std::move(item));
+        }
+        return true;
+    }
+};
+
+// Element types that map onto a JS typed array
+template <class T>
+struct TypedArrayKind;
+template <>
+struct TypedArrayKind<uint8_t> : std::integral_constant<JSTypedArrayEnum, JS_TYPED_ARRAY_UINT8> {};
+template <>
+struct TypedArrayKind<int32_t> : std::integral_constant<JSTypedArrayEnum, JS_TYPED_ARRAY_INT32> {};
+template <>
+struct TypedArrayKind<uint32_t>
+    : std::integral_constant<JSTypedArrayEnum, JS_TYPED_ARRAY_UINT32> {};
+template <>
+struct TypedArrayKind<float> : std::integral_constant<JSTypedArrayEnum, JS_TYPED_ARRAY_FLOAT32> {};
+template <>
+struct TypedArrayKind<double> : std::integral_constant<JSTypedArrayEnum, JS_TYPED_ARRAY_FLOAT64> {};
+
+template <class T>
+concept TypedArrayElement = requires { TypedArrayKind<T>::value; };
+
+// Numeric vectors <-> typed arrays (Papyrus int[] as Int32Array, float[] as Float32Array)
+//
+// to_js makes one copy into a fresh ArrayBuffer; from_js takes a typed array of the matching
+// element type with a single memcpy, and falls back to a plain JS array of numbers.
+template <TypedArrayElement T>
+struct JSConverter<std::vector<T>> {
+    static JSValue to_js(JSContext* ctx, const std::vector<T>& value) {
+        JSValue buffer = JS_NewArrayBufferCopy(
+            ctx, reinterpret_cast<const uint8_t*>(value.data()), value.size() * sizeof(T)
+        );
+        if (JS_IsException(buffer)) return buffer;
+        JSValue array = JS_NewTypedArray(ctx, 1, &buffer, TypedArrayKind<T>::value);
+        JS_FreeValue(ctx, buffer);
+        return array;
+    }
+    static bool from_js(JSContext* ctx, JSValueConst value, std::vector<T>& out) {
+        if (JS_GetTypedArrayType(value) != static_cast<int>(TypedArrayKind<T>::value))
+            return JS_IsArray(ctx, value) && from_js_array(ctx, value, out);
+
+        size_t  offset, length, element_size;
+        JSValue buffer = JS_GetTypedArrayBuffer(ctx, value, &offset, &length, &element_size);
+        if (JS_IsException(buffer)) return false;
+
+        size_t   size;
+        uint8_t* data = JS_GetArrayBuffer(ctx, &size, buffer);
+        JS_FreeValue(ctx, buffer);
+        if (!data && length != 0) return false;  // detached
+
+        out.resize(length / sizeof(T));
+        if (length != 0) memcpy(out.data(), data + offset, length);
+        return true;
+    }
+
+private:
+    static bool from_js_array(JSContext* ctx, JSValueConst value, std::vector<T>& out) {
+        JSValue  length_value = js_get_property(ctx, value, JSAtomName::length);
+        uint32_t length       = 0;
+        JS_ToUint32(ctx, &length, length_value);
+        JS_FreeValue(ctx, length_value);
+
+        out.resize(length);
+        for (uint32_t i = 0; i < length; i++) {
+            JSValue element = JS_GetPropertyUint32(ctx, value, i);
+            bool    ok      = JSConverter<T>::from_js(ctx, element, out[i]);
+            JS_FreeValue(ctx, element);
+            if (!ok) return false;
+        }
+        return true;
+    }
+};
+
+// Typed arrays that only live for the duration of one call
+//
+// array() copies the native elements into a fresh ArrayBuffer once, so a script may write to it
+// without touching the caller's data. The destructor detaches every buffer it handed out, which
+// frees it right away instead of at the next GC; a script that keeps a reference afterwards
+// sees an empty array.
+class CallTypedArrays {
+public:
+    explicit CallTypedArrays(JSContext* ctx) : ctx_(ctx) {}
+    ~CallTypedArrays() {
+        for (auto& buffer : buffers_) {
+            JS_DetachArrayBuffer(ctx_, buffer);
+            JS_FreeValue(ctx_, buffer);
+        }
+    }
+
+    CallTypedArrays(const CallTypedArrays&)            = delete;
+    CallTypedArrays& operator=(const CallTypedArrays&) = delete;
+
+    template <TypedArrayElement T>
+    JSValue array(std::span<const T> data) {
+        JSValue buffer = JS_NewArrayBufferCopy(
+            ctx_, reinterpret_cast<const uint8_t*>(data.data()), data.size_bytes()
+        );
+        if (JS_IsException(buffer)) return buffer;
+        JSValue array = JS_NewTypedArray(ctx_, 1, &buffer, TypedArrayKind<T>::value);
+        buffers_.push_back(buffer);
+        return array;
+    }
+
+private:
+    JSContext*           ctx_;
+    std::vector<JSValue> buffers_;
+};
+
+// Converts an argument for a single call: numeric vectors become call-scoped typed arrays,
+// everything else goes through JSConverter
+template <class T>
+JSValue to_js_argument(JSContext* ctx, CallTypedArrays& arrays, const T& value) {
+    return to_js(ctx, value);
+}
+
+template <TypedArrayElement T>
+JSValue to_js_argument(JSContext* ctx, CallTypedArrays& arrays, const std::vector<T>& value) {
+    return arrays.array(std::span<const T>(value));
+}
+
+namespace js_marshal_detail {
+    template <class F>
+    struct function_traits;
+
+    template <class R, class... Args>
+    struct function_traits<R (*)(Args...)> {
+        using result = R;
+        using args   = std::tuple<std::remove_cvref_t<Args>...>;
+    };
+
+    template <class R, class... Args>
+    struct function_traits<R (*)(Args...) noexcept> : function_traits<R (*)(Args...)> {};
+
+    template <class Tuple>
+    constexpr bool takes_context = false;
+
+    template <class... Rest>
+    constexpr bool takes_context<std::tuple<JSContext*, Rest...>> = true;
+}
+
+// JSCFunction thunk generated for `Fn`
+//
+// A leading JSContext* parameter receives the calling context; every other parameter is
+// converted from the matching argument (missing arguments convert from undefined, so only
+// std::optional parameters may be omitted). A JSValue result is returned as-is, which lets
+// bound functions throw by returning JS_Throw*().
+template <auto Fn>
+JSValue js_thunk(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    using traits = js_marshal_detail::function_traits<decltype(Fn)>;
+    using args_t = typename traits::args;
+    using R      = typename traits::result;
+
+    constexpr size_t first = js_marshal_detail::takes_context<args_t> ? 1 : 0;
+    constexpr size_t count = std::tuple_size_v<args_t> - first;
+
+    return [&]<size_t... I>(std::index_sequence<I...>) -> JSValue {
+        args_t args{};
+        if constexpr (first == 1) std::get<0>(args) = ctx;
+
+        int failed = -1;
+        (void)((failed < 0 &&
+                        !from_js(
+                            ctx, static_cast<int>(I) < argc ? argv[I] : JS_UNDEFINED,
+                            std::get<first + I>(args)
+                        )
+                    ? (failed = static_cast<int>(I), 0)
+                    : 0),
+               ...);
+        if (failed >= 0) return JS_ThrowTypeError(ctx, "invalid type for argument %d", failed + 1);
+
+        if constexpr (std::is_void_v<R>) {
+            std::apply(Fn, std::move(args));
+            return JS_UNDEFINED;
+        } else {
+            return to_js(ctx, std::apply(Fn, std::move(args)));
+        }
+    }(std::make_index_sequence<count>{});
+}
+
+// Number of JS arguments bind<Fn> expects (the `length` of the JS function)
+template <auto Fn>
+constexpr int js_arity() {
+    using args_t = typename js_marshal_detail::function_traits<decltype(Fn)>::args;
+    return static_cast<int>(
+        std::tuple_size_v<args_t> - (js_marshal_detail::takes_context<args_t> ? 1 : 0)
+    );
+}
+
+// Creates a JS function object backed by the generated thunk for `Fn`
+template <auto Fn>
+JSValue bind(JSContext* ctx, const char* name) {
+    return JS_NewCFunction(ctx, js_thunk<Fn>, name, js_arity<Fn>());
+}
+
+// A JSCFunctionListEntry for the generated thunk of `Fn`, for JS_SetPropertyFunctionList
+template <auto Fn>
+constexpr JSCFunctionListEntry js_bind_def(const char* name) {
+    return JS_CFUNC_DEF(name, js_arity<Fn>(), js_thunk<Fn>);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <type_traits>
+
+#include "js_marshal.h"
+#include "js_references.h"
+#include "papyrus_call_queue.h"
+
+// JSConverter specializations for game forms
+//
+// Forms cross into JS as { formID } objects (references as ObjectReference wrappers, which also
+// carry formID); coming back, either a FormID number or any object
+// carrying a numeric formID is accepted. FormIDs above 0x7FFFFFFF are not int-tagged, so they
+// are always read as uint32.
+
+template <>
+struct JSConverter<PapyrusFormRef> {
+    static JSValue to_js(JSContext* ctx, const PapyrusFormRef& value) {
+        JSValue form = JS_NewObject(ctx);
+        js_set_property(ctx, form, JSAtomName::formID, JS_NewUint32(ctx, value.form_id));
+        return form;
+    }
+    static bool from_js(JSContext* ctx, JSValueConst value, PapyrusFormRef& out) {
+        if (JS_IsNumber(value)) return JS_ToUint32(ctx, &out.form_id, value) == 0;
+        if (!JS_IsObject(value)) return false;
+
+        JSValue form_id = js_get_property(ctx, value, JSAtomName::formID);
+        bool    is_form = JS_IsNumber(form_id) && JS_ToUint32(ctx, &out.form_id, form_id) == 0;
+        JS_FreeValue(ctx, form_id);
+        return is_form;
+    }
+};
+
+// Pointers to TESForm and its subclasses; null maps to JS null, and a FormID that does not
+// resolve to a form of the requested type is a type mismatch
+template <class T>
+    requires std::is_base_of_v<RE::TESForm, T>
+struct JSConverter<T*> {
+    static JSValue to_js(JSContext* ctx, const T* form) {
+        if (!form) return JS_NULL;
+        // References become ObjectReference wrappers, so a game object keeps one JS identity
+        if (auto* reference = const_cast<T*>(form)->AsReference())
+            return reference_to_js(ctx, reference);
+        return JSConverter<PapyrusFormRef>::to_js(ctx, {form->GetFormID()});
+    }
+    static bool from_js(JSContext* ctx, JSValueConst value, T*& out) {
+        if (JS_IsNull(value) || JS_IsUndefined(value)) {
+            out = nullptr;
+            return true;
+        }
+        PapyrusFormRef ref;
+        if (!JSConverter<PapyrusFormRef>::from_js(ctx, value, ref)) return false;
+        out = RE::TESForm::LookupByID<T>(ref.form_id);
+        return out != nullptr;
+    }
+};
@@ -0,0 +1,156 @@
+#include "js_references.h"
+
+#include <format>
+#include <iterator>
+
+#include "js_atoms.h"
+#include "js_marshal_forms.h"
+#include "runtime_state.h"
+
+namespace {
+    JSClassID reference_class_id = 0;
+
+    struct ReferenceWrapper {
+        uint32_t            form_id;
+        RE::ObjectRefHandle handle;
+    };
+
+    void reference_finalizer(JSRuntime* rt, JSValue value) {
+        auto* wrapper = static_cast<ReferenceWrapper*>(JS_GetOpaque(value, reference_class_id));
+        if (!wrapper) return;
+
+        get_runtime_state(rt)->references.erase(wrapper->form_id, value);
+        delete wrapper;  // the handle is a plain value: nothing to hand back to the game
+    }
+
+    const JSClassDef reference_class = {
+        .class_name = "ObjectReference",
+        .finalizer  = reference_finalizer,
+    };
+
+    ReferenceWrapper* wrapper_of(JSContext* ctx, JSValueConst value) {
+        return static_cast<ReferenceWrapper*>(JS_GetOpaque2(ctx, value, reference_class_id));
+    }
+
+    // The live reference behind `this`; nullptr with an exception pending when there is none
+    RE::NiPointer<RE::TESObjectREFR> resolve(JSContext* ctx, JSValueConst this_val) {
+        auto* wrapper = wrapper_of(ctx, this_val);
+        if (!wrapper) return nullptr;
+
+        auto reference = wrapper->handle.get();
+        if (!reference) {
+            JS_ThrowReferenceError(
+                ctx, "ObjectReference %08X no longer exists", wrapper->form_id
+            );
+        }
+        return reference;
+    }
+
+    enum ReferenceProperty { form_id_property, base_property, name_property, position_property };
+
+    // Getter shared by the properties, which the table tells apart with `magic`
+    JSValue js_reference_get(JSContext* ctx, JSValueConst this_val, int magic) {
+        if (magic == form_id_property) {
+            auto* wrapper = wrapper_of(ctx, this_val);
+            return wrapper ? JS_NewUint32(ctx, wrapper->form_id) : JS_EXCEPTION;
+        }
+
+        auto reference = resolve(ctx, this_val);
+        if (!reference) return JS_EXCEPTION;
+
+        switch (magic) {
+            case base_property:
+                return to_js(ctx, static_cast<RE::TESForm*>(reference->GetBaseObject()));
+            case name_property: {
+                const char* name = reference->GetDisplayFullName();
+                return JS_NewString(ctx, name ? name : "");
+            }
+            case position_property: {
+                auto    position = reference->GetPosition();
+                JSValue result   = JS_NewObject(ctx);
+                js_set_property(ctx, result, JSAtomName::x, JS_NewFloat64(ctx, position.x));
+                js_set_property(ctx, result, JSAtomName::y, JS_NewFloat64(ctx, position.y));
+                js_set_property(ctx, result, JSAtomName::z, JS_NewFloat64(ctx, position.z));
+                return result;
+            }
+        }
+        return JS_UNDEFINED;
+    }
+
+    JSValue js_reference_is_valid(
+        JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+    ) {
+        auto* wrapper = wrapper_of(ctx, this_val);
+        if (!wrapper) return JS_EXCEPTION;
+        return JS_NewBool(ctx, wrapper->handle.get() != nullptr);
+    }
+
+    JSValue js_reference_to_string(
+        JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+    ) {
+        auto* wrapper = wrapper_of(ctx, this_val);
+        if (!wrapper) return JS_EXCEPTION;
+        return to_js(ctx, std::format("[ObjectReference {:08X}]", wrapper->form_id));
+    }
+
+    const JSCFunctionListEntry reference_prototype[] = {
+        JS_CGETSET_MAGIC_DEF("formID", js_reference_get, nullptr, form_id_property),
+        JS_CGETSET_MAGIC_DEF("base", js_reference_get, nullptr, base_property),
+        JS_CGETSET_MAGIC_DEF("name", js_reference_get, nullptr, name_property),
+        JS_CGETSET_MAGIC_DEF("position", js_reference_get, nullptr, position_property),
+        JS_PROP_STRING_DEF("[Symbol.toStringTag]", "ObjectReference", JS_PROP_CONFIGURABLE),
+        JS_CFUNC_DEF("isValid", 0, js_reference_is_valid),
+        JS_CFUNC_DEF("toString", 0, js_reference_to_string),
+    };
+}
+
+JSValue ReferenceCache::find(JSContext* ctx, uint32_t form_id) const {
+    auto found = wrappers_.find(form_id);
+    return found == wrappers_.end() ? JS_UNDEFINED : JS_DupValue(ctx, found->second);
+}
+
+void ReferenceCache::set(uint32_t form_id, JSValueConst wrapper) { wrappers_[form_id] = wrapper; }
+
+void ReferenceCache::erase(uint32_t form_id, JSValueConst wrapper) {
+    auto found = wrappers_.find(form_id);
+    if (found != wrappers_.end() && JS_VALUE_GET_PTR(found->second) == JS_VALUE_GET_PTR(wrapper))
+        wrappers_.erase(found);
+}
+
+void register_reference_class(JSRuntime* rt) {
+    if (!reference_class_id) JS_NewClassID(rt, &reference_class_id);
+    JS_NewClass(rt, reference_class_id, &reference_class);
+}
+
+void setup_reference_class(JSContext* ctx) {
+    JSValue prototype = JS_NewObject(ctx);
+    JS_SetPropertyFunctionList(
+        ctx, prototype, reference_prototype, static_cast<int>(std::size(reference_prototype))
+    );
+    JS_SetClassProto(ctx, reference_class_id, prototype);
+}
+
+JSValue reference_to_js(JSContext* ctx, RE::TESObjectREFR* reference) {
+    if (!reference) return JS_NULL;
+
+    auto&    cache   = get_runtime_state(JS_GetRuntime(ctx))->references;
+    uint32_t form_id = reference->GetFormID();
+    JSValue  cached  = cache.find(ctx, form_id);
+    if (!JS_IsUndefined(cached)) {
+        // Form IDs of deleted dynamic references get reused; a stale wrapper stays as it is
+        auto* wrapper = static_cast<ReferenceWrapper*>(JS_GetOpaque(cached, reference_class_id));
+        if (wrapper->handle.get().get() == reference) return cached;
+        JS_FreeValue(ctx, cached);
+    }
+
+    JSValue object = JS_NewObjectClass(ctx, reference_class_id);
+    if (JS_IsException(object)) return object;
+    JS_SetOpaque(object, new ReferenceWrapper{form_id, reference->GetHandle()});
+    cache.set(form_id, object);
+    return object;
+}
+
+RE::NiPointer<RE::TESObjectREFR> reference_from_js(JSContext* ctx, JSValueConst value) {
+    auto* wrapper = static_cast<ReferenceWrapper*>(JS_GetOpaque(value, reference_class_id));
+    return wrapper ? wrapper->handle.get() : nullptr;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SkyrimScripting/Plugin.h>
+
+#include "quickjs.h"
+
+// ObjectReference: JS wrappers for game references
+//
+// A wrapper holds the reference's handle, not a pointer, so it never dangles or keeps a deleted
+// reference alive; members resolve the handle on each access and report a reference that no
+// longer exists as invalid. The same reference always yields the same wrapper while that
+// wrapper is reachable (see ReferenceCache). An ObjectRefHandle is a plain value that holds no
+// count on the reference, so a finalized wrapper has nothing to release.
+
+// Registers the class with a runtime (once, before its first context)
+void register_reference_class(JSRuntime* rt);
+
+// Installs the class prototype in a context
+void setup_reference_class(JSContext* ctx);
+
+// The wrapper for `reference` (a new reference), or JS null for nullptr
+JSValue reference_to_js(JSContext* ctx, RE::TESObjectREFR* reference);
+
+// The reference a wrapper stands for, or nullptr for other values and deleted references
+RE::NiPointer<RE::TESObjectREFR> reference_from_js(JSContext* ctx, JSValueConst value);
@@ -0,0 +1,145 @@
+#include "js_world.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "js_atoms.h"
+#include "js_marshal.h"
+
+namespace {
+    struct Row {
+        uint32_t form_id;
+        float    x, y, z;
+        uint32_t flags;
+    };
+    static_assert(sizeof(Row) == 5 * 4, "a row is one element of each 4-byte column");
+
+    // Rows are gathered first because the number of matches is only known at the end
+    using Rows = std::vector<Row>;
+
+    void add_row(Rows& rows, RE::TESObjectREFR& reference) {
+        uint32_t flags = 0;
+        if (reference.IsDisabled()) flags |= world_flag_disabled;
+        if (reference.IsDeleted()) flags |= world_flag_deleted;
+        if (reference.Is3DLoaded()) flags |= world_flag_loaded;
+        if (auto* actor = reference.As<RE::Actor>()) {
+            flags |= world_flag_actor;
+            if (actor->IsDead()) flags |= world_flag_dead;
+            if (actor->IsInCombat()) flags |= world_flag_in_combat;
+        }
+        auto position = reference.GetPosition();
+        rows.push_back({reference.GetFormID(), position.x, position.y, position.z, flags});
+    }
+
+    // Visits every reference in the loaded cells; CommonLib flavors differ on whether the
+    // callback gets a pointer or a reference, so the lambda takes either
+    template <class Visit>
+    void for_each_loaded_reference(Visit visit) {
+        auto* tes = RE::TES::GetSingleton();
+        if (!tes) return;
+        tes->ForEachReference([&](auto&& reference) {
+            if constexpr (std::is_pointer_v<std::remove_cvref_t<decltype(reference)>>) {
+                if (reference) visit(*reference);
+            } else {
+                visit(reference);
+            }
+            return RE::BSContainer::ForEachResult::kContinue;
+        });
+    }
+
+    // A typed array over column `column` of a buffer holding `count` rows of 4-byte columns
+    template <class T>
+    JSValue column_view(JSContext* ctx, JSValueConst buffer, size_t column, size_t count) {
+        static_assert(sizeof(T) == 4);
+        JSValueConst args[] = {
+            buffer, JS_NewInt64(ctx, static_cast<int64_t>(column * count * sizeof(T))),
+            JS_NewInt64(ctx, static_cast<int64_t>(count))
+        };
+        return JS_NewTypedArray(ctx, 3, args, TypedArrayKind<T>::value);
+    }
+
+    // Transposes the rows into one ArrayBuffer, column after column, and returns the views
+    JSValue rows_to_js(JSContext* ctx, const Rows& rows) {
+        size_t count = rows.size();
+        size_t bytes = count * sizeof(Row);
+        auto*  data  = static_cast<uint8_t*>(js_malloc(ctx, std::max<size_t>(bytes, 1)));
+        if (!data) return JS_EXCEPTION;
+
+        auto* form_ids = reinterpret_cast<uint32_t*>(data);
+        auto* x        = reinterpret_cast<float*>(form_ids + count);
+        auto* y        = x + count;
+        auto* z        = y + count;
+        auto* flags    = reinterpret_cast<uint32_t*>(z + count);
+        for (size_t i = 0; i < count; i++) {
+            form_ids[i] = rows[i].form_id;
+            x[i]        = rows[i].x;
+            y[i]        = rows[i].y;
+            z[i]        = rows[i].z;
+            flags[i]    = rows[i].flags;
+        }
+
+        JSValue buffer = JS_NewArrayBuffer(
+            ctx, data, bytes, [](JSRuntime* rt, void*, void* ptr) { js_free_rt(rt, ptr); },
+            nullptr, false
+        );
+        if (JS_IsException(buffer)) {
+            js_free(ctx, data);
+            return buffer;
+        }
+
+        JSValue result = JS_NewObject(ctx);
+        js_set_property(
+            ctx, result, JSAtomName::count, JS_NewUint32(ctx, static_cast<uint32_t>(count))
+        );
+        js_set_property(
+            ctx, result, JSAtomName::formIDs, column_view<uint32_t>(ctx, buffer, 0, count)
+        );
+        js_set_property(ctx, result, JSAtomName::x, column_view<float>(ctx, buffer, 1, count));
+        js_set_property(ctx, result, JSAtomName::y, column_view<float>(ctx, buffer, 2, count));
+        js_set_property(ctx, result, JSAtomName::z, column_view<float>(ctx, buffer, 3, count));
+        js_set_property(
+            ctx, result, JSAtomName::flags, column_view<uint32_t>(ctx, buffer, 4, count)
+        );
+        JS_FreeValue(ctx, buffer);
+        return result;
+    }
+}
+
+JSValue world_actors(JSContext* ctx) {
+    Rows rows;
+    if (auto* player = RE::PlayerCharacter::GetSingleton()) add_row(rows, *player);
+
+    // Actors in loaded cells are processed in high or middle-high; the lower levels are the
+    // unloaded world
+    if (auto* processes = RE::ProcessLists::GetSingleton()) {
+        for (auto* handles : {&processes->highActorHandles, &processes->middleHighActorHandles}) {
+            for (auto& handle : *handles) {
+                auto  actor = handle.get();
+                auto* cell  = actor ? actor->GetParentCell() : nullptr;
+                if (cell && cell->IsAttached()) add_row(rows, *actor.get());
+            }
+        }
+    }
+    return rows_to_js(ctx, rows);
+}
+
+JSValue world_references(JSContext* ctx, RE::TESForm* base) {
+    if (!base) return JS_ThrowTypeError(ctx, "World.references: expected a base form");
+
+    Rows rows;
+    for_each_loaded_reference([&](RE::TESObjectREFR& reference) {
+        if (reference.GetBaseObject() == base) add_row(rows, reference);
+    });
+    return rows_to_js(ctx, rows);
+}
+
+JSValue world_references_of_type(JSContext* ctx, uint32_t form_type) {
+    Rows rows;
+    for_each_loaded_reference([&](RE::TESObjectREFR& reference) {
+        auto* base = reference.GetBaseObject();
+        if (base && static_cast<uint32_t>(base->GetFormType()) == form_type)
+            add_row(rows, reference);
+    });
+    return rows_to_js(ctx, rows);
+}
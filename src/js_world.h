@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <cstdint>
+
+#include "quickjs.h"
+
+// World: bulk queries over the loaded cells
+//
+// Each query walks the game's lists once and returns every match in one object of parallel
+// columns, { count, formIDs, x, y, z, flags }: a Uint32Array of FormIDs, Float32Arrays of
+// positions and a Uint32Array of WorldFlag bits, all views of a single ArrayBuffer. Row i of
+// every column describes the same reference, so scripts can scan hundreds of them without a
+// wrapper or property lookup per reference (reference_to_js gives the wrapper for one).
+
+enum WorldFlag : uint32_t {
+    world_flag_disabled  = 1 << 0,
+    world_flag_deleted   = 1 << 1,
+    world_flag_loaded    = 1 << 2,  // 3D is loaded
+    world_flag_actor     = 1 << 3,
+    world_flag_dead      = 1 << 4,  // actors only
+    world_flag_in_combat = 1 << 5,  // actors only
+};
+
+// World.actors(): the player and the processed actors whose cell is attached
+JSValue world_actors(JSContext* ctx);
+
+// World.references(base): references in the loaded cells whose base object is `base`
+JSValue world_references(JSContext* ctx, RE::TESForm* base);
+
+// World.referencesOfType(formType): references in the loaded cells whose base object is of the
+// given RE::FormType
+JSValue world_references_of_type(JSContext* ctx, uint32_t form_type);
@@ -0,0 +1,130 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    #include <cerrno>
+    #include <cstring>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    close();
+    data_    = std::exchange(other.data_, nullptr);
+    size_    = std::exchange(other.size_, 0);
+    is_open_ = std::exchange(other.is_open_, false);
+#ifdef _WIN32
+    file_    = std::exchange(other.file_, nullptr);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+    error_ = std::move(other.error_);
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+
+    HANDLE file = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        error_ = "cannot open file (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        error_ = "cannot read file size (error " + std::to_string(GetLastError()) + ")";
+        CloseHandle(file);
+        return false;
+    }
+
+    file_    = file;
+    is_open_ = true;
+    if (size.QuadPart == 0) return true;  // zero-length files cannot be mapped
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void*  view    = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        error_ = "cannot map file (error " + std::to_string(GetLastError()) + ")";
+        if (mapping) CloseHandle(mapping);
+        close();
+        return false;
+    }
+
+    mapping_ = mapping;
+    data_    = static_cast<const uint8_t*>(view);
+    size_    = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+    data_    = nullptr;
+    size_    = 0;
+    mapping_ = nullptr;
+    file_    = nullptr;
+    is_open_ = false;
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error_ = std::string("cannot open file: ") + strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        error_ = std::string("cannot read file size: ") + strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    is_open_ = true;
+    if (info.st_size > 0) {
+        auto  size = static_cast<size_t>(info.st_size);
+        void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            error_   = std::string("cannot map file: ") + strerror(errno);
+            is_open_ = false;
+            ::close(fd);
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(view);
+        size_ = size;
+    }
+
+    // The mapping keeps the file alive on its own
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+    data_    = nullptr;
+    size_    = 0;
+    is_open_ = false;
+}
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+
+// Read-only memory mapping of a whole file
+//
+// The mapping stays valid until close() or destruction; views handed out by parsers that work
+// on data() must not outlive it. Empty files open successfully with an empty span.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    std::span<const uint8_t> data() const { return {data_, size_}; }
+    size_t                   size() const { return size_; }
+    bool                     is_open() const { return is_open_; }
+    const std::string&       error() const { return error_; }
+
+private:
+    const uint8_t* data_    = nullptr;
+    size_t         size_    = 0;
+    bool           is_open_ = false;
+#ifdef _WIN32
+    void* file_    = nullptr;
+    void* mapping_ = nullptr;
+#endif
+    std::string error_;
+};
@@ -0,0 +1,137 @@
+#include "memory_usage.h"
+
+#include <format>
+
+#include "runtime_state.h"
+
+namespace {
+    std::string human_bytes(int64_t bytes) {
+        if (bytes >= 1024 * 1024) return std::format("{:.1f} MB", bytes / (1024.0 * 1024.0));
+        if (bytes >= 1024) return std::format("{:.1f} KB", bytes / 1024.0);
+        return std::format("{} B", bytes);
+    }
+
+    void set_number(JSContext* ctx, JSValue obj, const char* name, int64_t value) {
+        JS_SetPropertyStr(ctx, obj, name, JS_NewInt64(ctx, value));
+    }
+
+    JSValue count_and_size(JSContext* ctx, int64_t count, int64_t size) {
+        JSValue obj = JS_NewObject(ctx);
+        set_number(ctx, obj, "count", count);
+        set_number(ctx, obj, "size", size);
+        return obj;
+    }
+}
+
+MemoryReport collect_memory_report(JSContext* ctx, std::span<const NativeCacheSize> native_caches) {
+    MemoryReport report;
+    JSRuntime*   rt = JS_GetRuntime(ctx);
+    JS_ComputeMemoryUsage(rt, &report.usage);
+    if (auto* state = get_runtime_state(rt)) {
+        report.allocator = state->allocator.stats();
+        report.gc        = state->gc_scheduler.metrics();
+    }
+    report.native_caches.assign(native_caches.begin(), native_caches.end());
+    return report;
+}
+
+JSValue memory_report_to_js(JSContext* ctx, const MemoryReport& report) {
+    const auto& u   = report.usage;
+    JSValue     obj = JS_NewObject(ctx);
+
+    set_number(ctx, obj, "mallocSize", u.malloc_size);
+    set_number(ctx, obj, "mallocLimit", u.malloc_limit);
+    set_number(ctx, obj, "mallocCount", u.malloc_count);
+    set_number(ctx, obj, "memoryUsed", u.memory_used_size);
+
+    JS_SetPropertyStr(ctx, obj, "objects", count_and_size(ctx, u.obj_count, u.obj_size));
+    JS_SetPropertyStr(ctx, obj, "properties", count_and_size(ctx, u.prop_count, u.prop_size));
+    JS_SetPropertyStr(ctx, obj, "strings", count_and_size(ctx, u.str_count, u.str_size));
+    JS_SetPropertyStr(ctx, obj, "atoms", count_and_size(ctx, u.atom_count, u.atom_size));
+    JS_SetPropertyStr(ctx, obj, "shapes", count_and_size(ctx, u.shape_count, u.shape_size));
+    JS_SetPropertyStr(
+        ctx, obj, "binaryObjects", count_and_size(ctx, u.binary_object_count, u.binary_object_size)
+    );
+
+    JSValue bytecode = count_and_size(ctx, u.js_func_count, u.js_func_size);
+    set_number(ctx, bytecode, "codeSize", u.js_func_code_size);
+    set_number(ctx, bytecode, "pc2lineSize", u.js_func_pc2line_size);
+    set_number(ctx, bytecode, "nativeFunctions", u.c_func_count);
+    JS_SetPropertyStr(ctx, obj, "bytecode", bytecode);
+
+    JSValue arrays = JS_NewObject(ctx);
+    set_number(ctx, arrays, "count", u.array_count);
+    set_number(ctx, arrays, "fastCount", u.fast_array_count);
+    set_number(ctx, arrays, "fastElements", u.fast_array_elements);
+    JS_SetPropertyStr(ctx, obj, "arrays", arrays);
+
+    const auto& a         = report.allocator;
+    JSValue     allocator = JS_NewObject(ctx);
+    set_number(ctx, allocator, "bytesInUse", a.bytes_in_use);
+    set_number(ctx, allocator, "peakBytesInUse", a.peak_bytes_in_use);
+    set_number(ctx, allocator, "slabBytes", a.slab_bytes);
+    set_number(ctx, allocator, "largeBytes", a.large_bytes);
+    set_number(ctx, allocator, "liveAllocations", a.live_allocations);
+    JS_SetPropertyStr(ctx, obj, "allocator", allocator);
+
+    JSValue gc = JS_NewObject(ctx);
+    set_number(ctx, gc, "collections", report.gc.collections);
+    JS_SetPropertyStr(ctx, gc, "totalPauseMs", JS_NewFloat64(ctx, report.gc.total_pause_ms));
+    JS_SetPropertyStr(ctx, gc, "maxPauseMs", JS_NewFloat64(ctx, report.gc.max_pause_ms));
+    JS_SetPropertyStr(ctx, gc, "lastPauseMs", JS_NewFloat64(ctx, report.gc.last_pause_ms));
+    JS_SetPropertyStr(ctx, obj, "gc", gc);
+
+    JSValue caches = JS_NewObject(ctx);
+    for (const auto& cache : report.native_caches) {
+        JSValue entry = JS_NewObject(ctx);
+        set_number(ctx, entry, "entries", cache.entries);
+        set_number(ctx, entry, "bytes", cache.bytes);
+        JS_SetPropertyStr(ctx, caches, std::string(cache.name).c_str(), entry);
+    }
+    JS_SetPropertyStr(ctx, obj, "nativeCaches", caches);
+
+    return obj;
+}
+
+std::vector<std::string> format_memory_report(const MemoryReport& report) {
+    const auto&              u = report.usage;
+    std::vector<std::string> lines;
+
+    lines.push_back(std::format(
+        "JS memory: {} used of {} limit ({} blocks)", human_bytes(u.malloc_size),
+        u.malloc_limit > 0 ? human_bytes(u.malloc_limit) : "no", u.malloc_count
+    ));
+
+    auto row = [&lines](std::string_view label, int64_t count, int64_t size) {
+        lines.push_back(std::format("  {:<12} {:>8}  {:>10}", label, count, human_bytes(size)));
+    };
+    row("objects", u.obj_count, u.obj_size);
+    row("properties", u.prop_count, u.prop_size);
+    row("strings", u.str_count, u.str_size);
+    row("atoms", u.atom_count, u.atom_size);
+    row("shapes", u.shape_count, u.shape_size);
+    row("bytecode", u.js_func_count, u.js_func_size + u.js_func_code_size);
+    row("arrays", u.array_count, u.fast_array_elements * int64_t{sizeof(JSValue)});
+    row("binary", u.binary_object_count, u.binary_object_size);
+
+    const auto& a = report.allocator;
+    lines.push_back(std::format(
+        "  allocator: {} in use (peak {}), {} slabs, {} large", human_bytes(a.bytes_in_use),
+        human_bytes(a.peak_bytes_in_use), human_bytes(a.slab_bytes), human_bytes(a.large_bytes)
+    ));
+
+    const auto& gc = report.gc;
+    lines.push_back(std::format(
+        "  gc: {} scheduled collections ({} menu, {} loading, {} between frames), "
+        "max pause {:.2f} ms, total {:.2f} ms",
+        gc.collections, gc.menu_collections, gc.loading_collections, gc.frame_collections,
+        gc.max_pause_ms, gc.total_pause_ms
+    ));
+
+    for (const auto& cache : report.native_caches) {
+        lines.push_back(std::format(
+            "  {}: {} entries ({})", cache.name, cache.entries, human_bytes(cache.bytes)
+        ));
+    }
+    return lines;
+}
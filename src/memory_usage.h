@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gc_scheduler.h"
+#include "js_allocator.h"
+#include "quickjs.h"
+
+// Size of a native-side cache that holds on to JS values or game data for a context
+struct NativeCacheSize {
+    std::string_view name;
+    size_t           entries = 0;
+    size_t           bytes   = 0;  // approximate, excluding the JS values themselves
+};
+
+struct MemoryReport {
+    JSMemoryUsage                usage{};
+    JSAllocatorStats             allocator{};
+    GcMetrics                    gc{};
+    std::vector<NativeCacheSize> native_caches;
+};
+
+// Collects JS_ComputeMemoryUsage plus allocator stats for the context's runtime
+MemoryReport collect_memory_report(JSContext* ctx, std::span<const NativeCacheSize> native_caches);
+
+// Converts a report into the plain object returned by Engine.memoryUsage()
+JSValue memory_report_to_js(JSContext* ctx, const MemoryReport& report);
+
+// Formats a report as the lines printed by the `jsmem` console command
+std::vector<std::string> format_memory_report(const MemoryReport& report);
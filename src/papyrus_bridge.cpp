@@ -0,0 +1,341 @@
+#include "papyrus_bridge.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <format>
+#include <vector>
+
+#include "context_state.h"
+#include "event_log.h"
+#include "frame_pump.h"
+#include "js_atoms.h"
+
+namespace {
+    std::atomic<JSContext*> bridge_context = nullptr;
+
+    // Pumps between sweeps; the GC step requests a pump every frame while a runtime exists
+    constexpr int instance_sweep_interval = 600;
+    int           pumps_until_sweep       = instance_sweep_interval;
+
+    // An instance is kept while the VM still has an object for its handle and the handle's form
+    // ID (its low 32 bits) still looks up the object the instance was built for
+    bool instance_is_live(uint64_t handle, const void* object) {
+        auto* vm     = RE::BSScript::Internal::VirtualMachine::GetSingleton();
+        auto* policy = vm ? vm->GetObjectHandlePolicy() : nullptr;
+        if (policy && !policy->IsHandleObjectAvailable(handle)) return false;
+        return RE::TESForm::LookupByID(static_cast<RE::FormID>(handle)) == object;
+    }
+
+    // Frame pump step: every few seconds, drop the class instances of deleted objects, which
+    // Papyrus never reports, so the table does not keep every object a script has touched
+    void sweep_papyrus_instances() {
+        if (--pumps_until_sweep > 0) return;
+        pumps_until_sweep = instance_sweep_interval;
+
+        JSEntryLock lock;
+        JSContext*  ctx = bridge_context;
+        if (!ctx) return;
+        lock.enter(JS_GetRuntime(ctx));
+        auto*  classes = &get_context_state(ctx)->papyrus_classes;
+        size_t dropped = classes->instance_count() ? classes->sweep(ctx, instance_is_live) : 0;
+        if (dropped) log_event("Dropped {} Papyrus class instances of deleted objects", dropped);
+    }
+
+    bool iequals(std::string_view a, std::string_view b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                   return tolower(static_cast<unsigned char>(x)) ==
+                          tolower(static_cast<unsigned char>(y));
+               });
+    }
+
+    std::string lowercase(std::string_view str) {
+        std::string result(str);
+        for (auto& c : result) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    std::string qualified_name(size_t slot) {
+        const auto& declaration = papyrus_native_declarations()[slot];
+        return std::format("{}.{}", declaration.script, declaration.function);
+    }
+
+    // The function named `name` (case-insensitively) on `prototype` or the prototypes it
+    // inherits from, as a new reference; JS_UNDEFINED when there is none
+    JSValue find_method(JSContext* ctx, JSValueConst prototype, std::string_view name) {
+        JSValue object = JS_DupValue(ctx, prototype);
+        while (JS_IsObject(object)) {
+            JSPropertyEnum* properties = nullptr;
+            uint32_t        count      = 0;
+            if (JS_GetOwnPropertyNames(ctx, &properties, &count, object, JS_GPN_STRING_MASK) == 0) {
+                JSValue found = JS_UNDEFINED;
+                for (uint32_t i = 0; i < count && JS_IsUndefined(found); i++) {
+                    const char* key   = JS_AtomToCString(ctx, properties[i].atom);
+                    bool        match = key && iequals(key, name);
+                    if (key) JS_FreeCString(ctx, key);
+                    if (!match) continue;
+
+                    JSValue value = JS_GetProperty(ctx, object, properties[i].atom);
+                    if (JS_IsFunction(ctx, value)) found = value;
+                    else JS_FreeValue(ctx, value);
+                }
+                JS_FreePropertyEnum(ctx, properties, count);
+                if (!JS_IsUndefined(found)) {
+                    JS_FreeValue(ctx, object);
+                    return found;
+                }
+            }
+
+            JSValue parent = JS_GetPrototype(ctx, object);
+            JS_FreeValue(ctx, object);
+            object = parent;
+        }
+        JS_FreeValue(ctx, object);
+        return JS_UNDEFINED;
+    }
+}
+
+std::optional<size_t> find_papyrus_native(std::string_view script, std::string_view function) {
+    auto declarations = papyrus_native_declarations();
+    for (size_t slot = 0; slot < declarations.size(); slot++) {
+        if (iequals(declarations[slot].script, script) &&
+            iequals(declarations[slot].function, function))
+            return slot;
+    }
+    return std::nullopt;
+}
+
+void PapyrusNativeTable::set(JSContext* ctx, size_t slot, JSValueConst handler) {
+    if (handlers_.size() <= slot) handlers_.resize(slot + 1, JS_UNDEFINED);
+    JS_FreeValue(ctx, handlers_[slot]);
+    handlers_[slot] = JS_DupValue(ctx, handler);
+}
+
+JSValueConst PapyrusNativeTable::get(size_t slot) const {
+    return slot < handlers_.size() ? handlers_[slot] : JS_UNDEFINED;
+}
+
+void PapyrusNativeTable::clear(JSContext* ctx) {
+    for (auto& handler : handlers_) JS_FreeValue(ctx, handler);
+    handlers_.clear();
+}
+
+size_t PapyrusNativeTable::size() const {
+    return std::ranges::count_if(handlers_, [](JSValueConst h) { return !JS_IsUndefined(h); });
+}
+
+size_t PapyrusClassTable::set_class(
+    JSContext* ctx, std::string_view script, JSValueConst constructor
+) {
+    auto key   = lowercase(script);
+    auto found = std::ranges::find(classes_, key, &Class::script);
+    if (found == classes_.end()) {
+        found         = classes_.emplace(classes_.end());
+        found->script = key;
+    }
+
+    size_t index = found - classes_.begin();
+    for (auto& method : methods_) {
+        if (method.class_index != index) continue;
+        JS_FreeValue(ctx, method.function);
+        method.function = JS_UNDEFINED;
+    }
+    for (auto& [handle, instance] : found->instances) JS_FreeValue(ctx, instance.value);
+    found->instances.clear();
+    JS_FreeValue(ctx, found->constructor);
+    found->constructor = JS_DupValue(ctx, constructor);
+    return index;
+}
+
+void PapyrusClassTable::set_method(
+    JSContext* ctx, size_t slot, size_t class_index, JSValueConst function
+) {
+    if (methods_.size() <= slot) methods_.resize(slot + 1);
+    JS_FreeValue(ctx, methods_[slot].function);
+    methods_[slot] = {JS_DupValue(ctx, function), class_index};
+}
+
+std::optional<PapyrusClassTable::Method> PapyrusClassTable::method(size_t slot) const {
+    if (slot >= methods_.size() || JS_IsUndefined(methods_[slot].function)) return std::nullopt;
+    return Method{methods_[slot].function, methods_[slot].class_index};
+}
+
+JSValue PapyrusClassTable::instance(
+    JSContext* ctx, size_t class_index, uint64_t handle, const void* object, JSValueConst self
+) {
+    auto& instances = classes_[class_index].instances;
+    if (auto found = instances.find(handle); found != instances.end()) {
+        if (found->second.object == object) return JS_DupValue(ctx, found->second.value);
+        // A recycled handle: the state belongs to a deleted object
+        JS_FreeValue(ctx, found->second.value);
+        instances.erase(found);
+    }
+
+    // The constructor may register classes or call back into Papyrus, so the class is looked
+    // up again after it: a replaced class keeps none of the old one's instances, and an
+    // instance bound by a nested call wins
+    JSValue constructor = JS_DupValue(ctx, classes_[class_index].constructor);
+    JSValue created     = JS_CallConstructor(ctx, constructor, 1, &self);
+    void*   current     = JS_VALUE_GET_PTR(classes_[class_index].constructor);
+    bool    replaced    = current != JS_VALUE_GET_PTR(constructor);
+    JS_FreeValue(ctx, constructor);
+    if (JS_IsException(created) || replaced) return created;
+
+    auto& bound            = classes_[class_index].instances;
+    auto [entry, inserted] = bound.try_emplace(handle, Instance{object, created});
+    if (inserted) return JS_DupValue(ctx, created);
+    JS_FreeValue(ctx, created);
+    return JS_DupValue(ctx, entry->second.value);
+}
+
+size_t PapyrusClassTable::sweep(
+    JSContext* ctx, bool (*keep)(uint64_t handle, const void* object)
+) {
+    size_t dropped = 0;
+    for (auto& entry : classes_) {
+        dropped += std::erase_if(entry.instances, [&](const auto& item) {
+            if (keep(item.first, item.second.object)) return false;
+            JS_FreeValue(ctx, item.second.value);
+            return true;
+        });
+    }
+    return dropped;
+}
+
+void PapyrusClassTable::clear(JSContext* ctx) {
+    for (auto& method : methods_) JS_FreeValue(ctx, method.function);
+    for (auto& entry : classes_) {
+        for (auto& [handle, instance] : entry.instances) JS_FreeValue(ctx, instance.value);
+        JS_FreeValue(ctx, entry.constructor);
+    }
+    methods_.clear();
+    classes_.clear();
+}
+
+size_t PapyrusClassTable::instance_count() const {
+    size_t count = 0;
+    for (const auto& entry : classes_) count += entry.instances.size();
+    return count;
+}
+
+void set_papyrus_bridge_context(JSContext* ctx) { bridge_context = ctx; }
+
+JSContext* papyrus_bridge_context() { return bridge_context; }
+
+uint64_t papyrus_object_handle(const RE::TESForm* form) {
+    if (!form) return 0;
+    auto* vm     = RE::BSScript::Internal::VirtualMachine::GetSingleton();
+    auto* policy = vm ? vm->GetObjectHandlePolicy() : nullptr;
+    if (!policy) return form->GetFormID();
+    return policy->GetHandleForObject(static_cast<RE::VMTypeID>(form->GetFormType()), form);
+}
+
+void register_papyrus_instance_sweep() { add_frame_pump_step(sweep_papyrus_instances); }
+
+namespace papyrus_bridge {
+    PapyrusNativeTable* native_table(JSContext* ctx) {
+        return &get_context_state(ctx)->papyrus_natives;
+    }
+
+    PendingLatentCalls* latent_calls(JSContext* ctx) {
+        return &get_context_state(ctx)->latent_calls;
+    }
+
+    PapyrusClassTable* class_table(JSContext* ctx) {
+        return &get_context_state(ctx)->papyrus_classes;
+    }
+
+    void log_missing_handler(size_t slot) {
+        log_event(
+            "Papyrus called {} but no JavaScript implementation is registered", qualified_name(slot)
+        );
+    }
+
+    void log_exception(JSContext* ctx, size_t slot) {
+        JSValue     exception = JS_GetException(ctx);
+        const char* message   = JS_ToCString(ctx, exception);
+        log_event(
+            "JavaScript implementation of {} threw: {}", qualified_name(slot),
+            message ? message : "unknown"
+        );
+        if (message) JS_FreeCString(ctx, message);
+        JS_FreeValue(ctx, exception);
+    }
+
+    void log_rejection(JSContext* ctx, size_t slot, JSValueConst reason) {
+        const char* message = JS_ToCString(ctx, reason);
+        log_event(
+            "JavaScript implementation of {} rejected: {}", qualified_name(slot),
+            message ? message : "unknown"
+        );
+        if (message) JS_FreeCString(ctx, message);
+    }
+
+    void log_bad_result(size_t slot) {
+        log_event(
+            "JavaScript implementation of {} returned a value of the wrong type",
+            qualified_name(slot)
+        );
+    }
+}
+
+JSValue papyrus_register_native(
+    JSContext* ctx, std::string script, std::string function, JSValue handler
+) {
+    if (!JS_IsFunction(ctx, handler))
+        return JS_ThrowTypeError(ctx, "registerNative expects (script, function, handler)");
+
+    auto slot = find_papyrus_native(script, function);
+    if (!slot) {
+        return JS_ThrowTypeError(
+            ctx, "%s.%s is not a declared Papyrus native", script.c_str(), function.c_str()
+        );
+    }
+
+    papyrus_bridge::native_table(ctx)->set(ctx, *slot, handler);
+    log_event("Registered JavaScript implementation of {}", qualified_name(*slot));
+    return JS_UNDEFINED;
+}
+
+JSValue papyrus_register_class(JSContext* ctx, std::string script, JSValue constructor) {
+    if (!JS_IsConstructor(ctx, constructor))
+        return JS_ThrowTypeError(ctx, "registerClass expects (script, class)");
+
+    // Latent natives resume their stack from a promise, so they stay with registerNative
+    std::vector<size_t> slots;
+    auto                declarations = papyrus_native_declarations();
+    for (size_t slot = 0; slot < declarations.size(); slot++) {
+        const auto& declaration = declarations[slot];
+        if (declaration.member && !declaration.latent && iequals(declaration.script, script))
+            slots.push_back(slot);
+    }
+    if (slots.empty()) {
+        return JS_ThrowTypeError(
+            ctx, "%s declares no member natives a class can implement", script.c_str()
+        );
+    }
+
+    JSValue prototype = js_get_property(ctx, constructor, JSAtomName::prototype);
+    if (JS_IsException(prototype)) return prototype;
+
+    auto*  classes     = papyrus_bridge::class_table(ctx);
+    size_t class_index = classes->set_class(ctx, script, constructor);
+    size_t bound       = 0;
+    for (auto slot : slots) {
+        JSValue method = find_method(ctx, prototype, declarations[slot].function);
+        if (JS_IsUndefined(method)) {
+            log_event(
+                "JavaScript class for {} has no {} method; registerNative handles it", script,
+                declarations[slot].function
+            );
+            continue;
+        }
+        classes->set_method(ctx, slot, class_index, method);
+        JS_FreeValue(ctx, method);
+        bound++;
+    }
+    JS_FreeValue(ctx, prototype);
+
+    log_event("Registered JavaScript class for {} ({} of {} natives)", script, bound, slots.size());
+    return JS_UNDEFINED;
+}
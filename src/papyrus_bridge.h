@@ -0,0 +1,233 @@
+#pragma once
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "js_entry.h"
+#include "js_jobs.h"
+#include "js_marshal_forms.h"
+#include "papyrus_class_table.h"
+#include "papyrus_latent.h"
+#include "papyrus_native_table.h"
+#include "quickjs.h"
+
+// A Papyrus native function whose implementation can be provided from JS
+struct PapyrusNativeDeclaration {
+    std::string_view script;
+    std::string_view function;
+    uint8_t          arity;
+    bool             latent = false;  // registered with RegisterLatentFunction
+    bool             member = false;  // called on an object, which is passed as `self`
+};
+
+// Every declared native, indexed by dispatch slot (see papyrus_natives.cpp)
+std::span<const PapyrusNativeDeclaration> papyrus_native_declarations();
+
+// Registers the natives' C++ thunks with the Papyrus VM
+bool register_papyrus_natives(RE::BSScript::IVirtualMachine* vm);
+
+// Resolves a (script, function) pair to its dispatch slot; Papyrus names are case-insensitive
+std::optional<size_t> find_papyrus_native(std::string_view script, std::string_view function);
+
+// The context Papyrus natives dispatch into (nullptr while no JS environment is running)
+void       set_papyrus_bridge_context(JSContext* ctx);
+JSContext* papyrus_bridge_context();
+
+// Papyrus.registerNative(script, function, handler), exposed through bind<>
+JSValue papyrus_register_native(
+    JSContext* ctx, std::string script, std::string function, JSValue handler
+);
+
+// Papyrus.registerClass(script, constructor), exposed through bind<>
+JSValue papyrus_register_class(JSContext* ctx, std::string script, JSValue constructor);
+
+// The VM handle Papyrus binds script instances on `form` to (its form ID outside the VM)
+uint64_t papyrus_object_handle(const RE::TESForm* form);
+
+// Adds the step that drops class instances of deleted objects to the frame pump (call once at
+// plugin load)
+void register_papyrus_instance_sweep();
+
+namespace papyrus_bridge {
+    void log_missing_handler(size_t slot);
+    void log_exception(JSContext* ctx, size_t slot);
+    void log_bad_result(size_t slot);
+    void log_rejection(JSContext* ctx, size_t slot, JSValueConst reason);
+    PapyrusNativeTable* native_table(JSContext* ctx);
+    PendingLatentCalls* latent_calls(JSContext* ctx);
+    PapyrusClassTable*  class_table(JSContext* ctx);
+
+    // Converts and frees a handler's result; R() when it threw or has the wrong type
+    template <class R>
+    R take_result(JSContext* ctx, size_t slot, JSValue result) {
+        if (JS_IsException(result)) {
+            log_exception(ctx, slot);
+            return R();
+        }
+
+        if constexpr (std::is_void_v<R>) {
+            JS_FreeValue(ctx, result);
+        } else {
+            R value{};
+            if (!from_js(ctx, result, value)) {
+                log_bad_result(slot);
+                value = R();
+            }
+            JS_FreeValue(ctx, result);
+            return value;
+        }
+    }
+}
+
+// Calls the JS implementation of the native in `slot` from a Papyrus VM thread
+//
+// Arguments and the result go through JSConverter (js_marshal.h); int[]/float[] arguments are
+// copied into typed arrays that are detached when the handler returns. Returns R() when no
+// JS environment is running, no handler is registered, or the handler throws or returns a
+// value that does not convert to R; the handler itself is looked up by slot, so no names are
+// resolved per call.
+template <class R, class... Args>
+R call_papyrus_native(size_t slot, const Args&... args) {
+    if (!papyrus_bridge_context()) return R();
+
+    JSEntryLock lock;
+    JSContext*  ctx = papyrus_bridge_context();  // torn down while waiting for the lock?
+    if (!ctx) return R();
+    lock.enter(JS_GetRuntime(ctx));
+
+    JSValueConst handler = papyrus_bridge::native_table(ctx)->get(slot);
+    if (JS_IsUndefined(handler)) {
+        papyrus_bridge::log_missing_handler(slot);
+        return R();
+    }
+
+    CallTypedArrays                      arrays(ctx);  // numeric arrays, freed after the call
+    std::array<JSValue, sizeof...(Args)> js_args{to_js_argument(ctx, arrays, args)...};
+    JSValue result = JS_Call(ctx, handler, JS_UNDEFINED, int{sizeof...(Args)}, js_args.data());
+    for (auto& arg : js_args) JS_FreeValue(ctx, arg);
+    return papyrus_bridge::take_result<R>(ctx, slot, result);
+}
+
+// Calls the member native in `slot` on `self` from a Papyrus VM thread
+//
+// When a class is registered for the native's script, the call goes to its method, with `this`
+// set to the JS object bound to `self` (created on the first call for that object) and the
+// arguments passed as they are. Otherwise the native falls back to its registerNative handler,
+// which receives `self` as its first argument. Returns R() in the same cases as
+// call_papyrus_native, and when the bound object's constructor throws.
+template <class R, class Self, class... Args>
+R call_papyrus_method(size_t slot, Self* self, const Args&... args) {
+    if (!papyrus_bridge_context()) return R();
+
+    JSEntryLock lock;
+    JSContext*  ctx = papyrus_bridge_context();
+    if (!ctx) return R();
+    lock.enter(JS_GetRuntime(ctx));
+
+    auto* classes = papyrus_bridge::class_table(ctx);
+    auto  method  = classes->method(slot);
+    if (!method || !self) return call_papyrus_native<R>(slot, self, args...);
+
+    // The table only lends the method, and the constructor below may replace it
+    // Instances record the TESForm pointer, which is what the sweep's form lookups return
+    const RE::TESForm* form     = self;
+    JSValue            function = JS_DupValue(ctx, method->function);
+    JSValue            js_self  = to_js(ctx, self);
+    JSValue            instance = classes->instance(
+        ctx, method->class_index, papyrus_object_handle(form), form, js_self
+    );
+    JS_FreeValue(ctx, js_self);
+    if (JS_IsException(instance)) {
+        JS_FreeValue(ctx, function);
+        papyrus_bridge::log_exception(ctx, slot);
+        return R();
+    }
+
+    JSValue result;
+    {
+        CallTypedArrays                      arrays(ctx);
+        std::array<JSValue, sizeof...(Args)> js_args{to_js_argument(ctx, arrays, args)...};
+        result = JS_Call(ctx, function, instance, int{sizeof...(Args)}, js_args.data());
+        for (auto& arg : js_args) JS_FreeValue(ctx, arg);
+    }
+    JS_FreeValue(ctx, instance);
+    JS_FreeValue(ctx, function);
+    return papyrus_bridge::take_result<R>(ctx, slot, result);
+}
+
+// Calls the JS implementation of the latent native in `slot` and leaves the Papyrus stack
+// `stack_id` suspended until the handler's promise settles
+//
+// The handler may return a promise (an async function) or a plain value. Whatever happens,
+// the stack is resumed exactly once: with the converted result, or with R() when there is no
+// JS environment or handler, or the handler throws, rejects, or is torn down first.
+template <class R, class... Args>
+bool call_latent_papyrus_native(size_t slot, RE::VMStackID stack_id, const Args&... args) {
+    static_assert(!std::is_void_v<R>, "latent natives must return a value");
+
+    auto resume = [stack_id](R value) {
+        queue_latent_resume(
+            [stack_id, value = std::move(value)](RE::BSScript::Internal::VirtualMachine* vm) {
+                vm->ReturnLatentResult<R>(stack_id, value);
+            }
+        );
+    };
+
+    if (!papyrus_bridge_context()) {
+        resume(R());
+        return true;
+    }
+
+    JSEntryLock lock;
+    JSContext*  ctx = papyrus_bridge_context();
+    if (!ctx) {
+        resume(R());
+        return true;
+    }
+    lock.enter(JS_GetRuntime(ctx));
+
+    JSValueConst handler = papyrus_bridge::native_table(ctx)->get(slot);
+    if (JS_IsUndefined(handler)) {
+        papyrus_bridge::log_missing_handler(slot);
+        resume(R());
+        return true;
+    }
+
+    JSValue result;
+    {
+        CallTypedArrays                      arrays(ctx);
+        std::array<JSValue, sizeof...(Args)> js_args{to_js_argument(ctx, arrays, args)...};
+        result = JS_Call(ctx, handler, JS_UNDEFINED, int{sizeof...(Args)}, js_args.data());
+        for (auto& arg : js_args) JS_FreeValue(ctx, arg);
+    }
+
+    if (JS_IsException(result)) {
+        papyrus_bridge::log_exception(ctx, slot);
+        resume(R());
+        return true;
+    }
+
+    papyrus_bridge::latent_calls(ctx)->await(
+        ctx, result,
+        [slot, resume](JSContext* ctx, JSValueConst value, LatentOutcome outcome) {
+            R converted{};
+            if (outcome == LatentOutcome::rejected) {
+                papyrus_bridge::log_rejection(ctx, slot, value);
+            } else if (outcome == LatentOutcome::fulfilled && !from_js(ctx, value, converted)) {
+                papyrus_bridge::log_bad_result(slot);
+            }
+            resume(outcome == LatentOutcome::fulfilled ? std::move(converted) : R());
+        }
+    );
+    JS_FreeValue(ctx, result);
+
+    // Let handlers that finish without waiting on anything resume the stack in the next pump
+    run_pending_js_jobs(JS_GetRuntime(ctx));
+    return true;
+}
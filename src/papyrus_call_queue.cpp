@@ -0,0 +1,35 @@
+#include "papyrus_call_queue.h"
+
+#include <utility>
+
+uint64_t PapyrusCallQueue::enqueue(PapyrusCall call) {
+    std::lock_guard lock(mutex_);
+    call.id = next_id_++;
+    pending_.push_back(std::move(call));
+    return pending_.back().id;
+}
+
+uint64_t PapyrusCallQueue::next_id() {
+    std::lock_guard lock(mutex_);
+    return next_id_++;
+}
+
+std::vector<PapyrusCall> PapyrusCallQueue::take_pending() {
+    std::lock_guard lock(mutex_);
+    return std::exchange(pending_, {});
+}
+
+void PapyrusCallQueue::complete(PapyrusCallResult result) {
+    std::lock_guard lock(mutex_);
+    completed_.push_back(std::move(result));
+}
+
+std::vector<PapyrusCallResult> PapyrusCallQueue::take_completed() {
+    std::lock_guard lock(mutex_);
+    return std::exchange(completed_, {});
+}
+
+size_t PapyrusCallQueue::pending_count() {
+    std::lock_guard lock(mutex_);
+    return pending_.size();
+}
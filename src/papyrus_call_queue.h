@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+// A form passed to or returned from Papyrus, identified by its FormID
+struct PapyrusFormRef {
+    uint32_t form_id = 0;
+};
+
+using PapyrusValue = std::variant<std::monostate, bool, int32_t, float, std::string, PapyrusFormRef>;
+
+// A Papyrus function call requested from JS
+struct PapyrusCall {
+    uint64_t                      id = 0;
+    std::optional<PapyrusFormRef> self;  // member call on this form, or a global call
+    std::string                   script;
+    std::string                   function;
+    std::vector<PapyrusValue>     args;
+};
+
+struct PapyrusCallResult {
+    uint64_t     id = 0;
+    bool         ok = false;
+    PapyrusValue value;
+    std::string  error;
+};
+
+// Collects Papyrus calls so they can be dispatched to the VM in one batch per frame, and the
+// results the VM hands back (on its own threads) until JS can pick them up
+class PapyrusCallQueue {
+public:
+    // Queues a call and returns its id
+    uint64_t enqueue(PapyrusCall call);
+
+    // Assigns an id to a call that is dispatched immediately instead of queued
+    uint64_t next_id();
+
+    std::vector<PapyrusCall> take_pending();
+
+    void                           complete(PapyrusCallResult result);
+    std::vector<PapyrusCallResult> take_completed();
+
+    size_t pending_count();
+
+private:
+    std::mutex                     mutex_;
+    uint64_t                       next_id_ = 1;
+    std::vector<PapyrusCall>       pending_;
+    std::vector<PapyrusCallResult> completed_;
+};
@@ -0,0 +1,229 @@
+#include "papyrus_calls.h"
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <atomic>
+#include <format>
+
+#include "context_state.h"
+#include "frame_pump.h"
+#include "js_entry.h"
+#include "js_jobs.h"
+#include "js_marshal_forms.h"
+#include "papyrus_bridge.h"
+
+namespace {
+    PapyrusCallQueue  call_queue;
+    std::atomic<bool> batch_calls = true;
+
+    // Packs queued arguments into the VM's argument array when the call is dispatched
+    class PapyrusCallArguments : public RE::BSScript::IFunctionArguments {
+    public:
+        explicit PapyrusCallArguments(std::vector<PapyrusValue> args) : args_(std::move(args)) {}
+
+        bool operator()(RE::BSScript::BSScrapArray<RE::BSScript::Variable>& a_dst) const override {
+            a_dst.resize(static_cast<uint32_t>(args_.size()));
+            for (size_t i = 0; i < args_.size(); i++) {
+                auto& variable = a_dst[static_cast<uint32_t>(i)];
+                std::visit(
+                    [&variable](const auto& value) {
+                        using T = std::decay_t<decltype(value)>;
+                        if constexpr (std::is_same_v<T, std::monostate>) {
+                            variable.SetNone();
+                        } else if constexpr (std::is_same_v<T, bool>) {
+                            variable.SetBool(value);
+                        } else if constexpr (std::is_same_v<T, int32_t>) {
+                            variable.SetSInt(value);
+                        } else if constexpr (std::is_same_v<T, float>) {
+                            variable.SetFloat(value);
+                        } else if constexpr (std::is_same_v<T, std::string>) {
+                            variable.SetString(value);
+                        } else {
+                            if (auto* form = RE::TESForm::LookupByID(value.form_id))
+                                variable.Pack(form);
+                            else
+                                variable.SetNone();
+                        }
+                    },
+                    args_[i]
+                );
+            }
+            return true;
+        }
+
+    private:
+        std::vector<PapyrusValue> args_;
+    };
+
+    PapyrusValue papyrus_value_from_variable(const RE::BSScript::Variable& variable) {
+        if (variable.IsBool()) return variable.GetBool();
+        if (variable.IsInt()) return variable.GetSInt();
+        if (variable.IsFloat()) return variable.GetFloat();
+        if (variable.IsString()) return std::string(variable.GetString());
+        if (variable.IsObject()) {
+            if (auto* form = variable.Unpack<RE::TESForm*>())
+                return PapyrusFormRef{form->GetFormID()};
+        }
+        return std::monostate{};
+    }
+
+    // Hands the VM's result back to the queue from whichever VM thread finished the call
+    class PapyrusCallCallback : public RE::BSScript::IStackCallbackFunctor {
+    public:
+        explicit PapyrusCallCallback(uint64_t id) : id_(id) {}
+
+        void operator()(RE::BSScript::Variable a_result) override {
+            call_queue.complete(
+                {.id = id_, .ok = true, .value = papyrus_value_from_variable(a_result)}
+            );
+            request_frame_pump();
+        }
+
+        bool CanSave() const override { return false; }
+        void SetObject(const RE::BSTSmartPointer<RE::BSScript::Object>&) override {}
+
+    private:
+        uint64_t id_;
+    };
+
+    void fail_call(const PapyrusCall& call, std::string error) {
+        call_queue.complete({.id = call.id, .ok = false, .error = std::move(error)});
+    }
+
+    void dispatch_call(RE::BSScript::Internal::VirtualMachine* vm, PapyrusCall& call) {
+        RE::BSTSmartPointer<RE::BSScript::IStackCallbackFunctor> callback{
+            new PapyrusCallCallback(call.id)
+        };
+        auto* args = new PapyrusCallArguments(std::move(call.args));
+
+        bool dispatched = false;
+        if (call.self) {
+            auto* form = RE::TESForm::LookupByID(call.self->form_id);
+            if (!form) {
+                delete args;
+                return fail_call(call, std::format("no form {:08X}", call.self->form_id));
+            }
+            auto* policy = vm->GetObjectHandlePolicy();
+            auto  handle =
+                policy->GetHandleForObject(static_cast<RE::VMTypeID>(form->GetFormType()), form);
+            dispatched = vm->DispatchMethodCall(
+                handle, call.script.c_str(), call.function.c_str(), args, callback
+            );
+        } else {
+            dispatched =
+                vm->DispatchStaticCall(call.script.c_str(), call.function.c_str(), args, callback);
+        }
+
+        if (!dispatched)
+            fail_call(call, std::format("could not call {}.{}", call.script, call.function));
+    }
+
+    // Frame pump step: send every queued call to the VM
+    void dispatch_pending_calls() {
+        auto calls = call_queue.take_pending();
+        if (calls.empty()) return;
+
+        auto* vm = RE::BSScript::Internal::VirtualMachine::GetSingleton();
+        for (auto& call : calls) {
+            if (vm) dispatch_call(vm, call);
+            else fail_call(call, "Papyrus VM is not available");
+        }
+        if (!vm) request_frame_pump();
+    }
+
+    // Frame pump step: settle the promises of finished calls and run the jobs they queue
+    void settle_completed_calls() {
+        auto results = call_queue.take_completed();
+        if (results.empty()) return;
+
+        JSEntryLock lock;
+        JSContext*  ctx = papyrus_bridge_context();
+        if (!ctx) return;
+        lock.enter(JS_GetRuntime(ctx));
+
+        auto& promises = get_context_state(ctx)->papyrus_calls;
+        for (auto& result : results) {
+            JSValue value = result.ok ? papyrus_value_to_js(ctx, result.value)
+                                      : JS_NewError(ctx);
+            if (!result.ok) {
+                JS_SetPropertyStr(
+                    ctx, value, "message",
+                    JS_NewStringLen(ctx, result.error.data(), result.error.size())
+                );
+            }
+            promises.settle(ctx, result.id, result.ok, value);
+        }
+        run_pending_js_jobs(JS_GetRuntime(ctx));
+    }
+
+    JSValue enqueue_call(
+        JSContext* ctx, std::optional<PapyrusFormRef> self, int argc, JSValueConst* argv
+    ) {
+        PapyrusCall call{.self = self};
+        if (argc < 2 || !from_js(ctx, argv[0], call.script) ||
+            !from_js(ctx, argv[1], call.function))
+            return JS_ThrowTypeError(ctx, "expected (script, function, ...args)");
+
+        call.args.reserve(argc - 2);
+        for (int i = 2; i < argc; i++) call.args.push_back(papyrus_value_from_js(ctx, argv[i]));
+
+        bool    batched = batch_calls;
+        call.id         = batched ? 0 : call_queue.next_id();
+        uint64_t id     = batched ? call_queue.enqueue(std::move(call)) : call.id;
+
+        JSValue promise = get_context_state(ctx)->papyrus_calls.create(ctx, id);
+
+        if (!batched) {
+            if (auto* vm = RE::BSScript::Internal::VirtualMachine::GetSingleton())
+                dispatch_call(vm, call);
+            else
+                fail_call(call, "Papyrus VM is not available");
+        }
+        request_frame_pump();
+        return promise;
+    }
+}
+
+void set_papyrus_call_batching(bool enabled) { batch_calls = enabled; }
+
+void register_papyrus_call_pump() {
+    add_frame_pump_step(dispatch_pending_calls);
+    add_frame_pump_step(settle_completed_calls);
+}
+
+PapyrusValue papyrus_value_from_js(JSContext* ctx, JSValueConst value) {
+    if (JS_IsBool(value)) return JS_VALUE_GET_BOOL(value) != 0;
+    if (JS_VALUE_GET_TAG(value) == JS_TAG_INT) return JS_VALUE_GET_INT(value);
+    if (float number; from_js(ctx, value, number)) return number;
+    if (std::string str; from_js(ctx, value, str)) return str;
+    // Anything carrying a formID (plain objects or game object wrappers) is passed as a form
+    if (PapyrusFormRef form; JS_IsObject(value) && from_js(ctx, value, form)) return form;
+    return std::monostate{};
+}
+
+JSValue papyrus_value_to_js(JSContext* ctx, const PapyrusValue& value) {
+    return std::visit(
+        [ctx](const auto& v) -> JSValue {
+            if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::monostate>)
+                return JS_NULL;
+            else
+                return to_js(ctx, v);
+        },
+        value
+    );
+}
+
+JSValue js_papyrus_call(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    return enqueue_call(ctx, std::nullopt, argc, argv);
+}
+
+JSValue js_papyrus_call_method(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+) {
+    if (argc < 1) return JS_ThrowTypeError(ctx, "expected (form, script, function, ...args)");
+
+    PapyrusFormRef self;
+    if (!from_js(ctx, argv[0], self))
+        return JS_ThrowTypeError(ctx, "callMethod expects a form or FormID first");
+    return enqueue_call(ctx, self, argc - 1, argv + 1);
+}
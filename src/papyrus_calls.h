@@ -0,0 +1,25 @@
+#pragma once
+
+#include "papyrus_call_queue.h"
+#include "quickjs.h"
+
+// Calls from JS into Papyrus functions
+//
+// Papyrus.call(script, function, ...args) and Papyrus.callMethod(form, script, function, ...args)
+// return Promises. With batching on (the default) calls are queued and sent to the VM together
+// from the next frame's pump; otherwise each call is dispatched as soon as it is made. Results
+// come back on VM threads and settle their promises in the following pump.
+
+void set_papyrus_call_batching(bool enabled);
+
+// Adds the dispatch/settle steps to the frame pump (call once at plugin load)
+void register_papyrus_call_pump();
+
+JSValue js_papyrus_call(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+JSValue js_papyrus_call_method(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+);
+
+// JS <-> Papyrus value conversion shared with the other bridges
+PapyrusValue papyrus_value_from_js(JSContext* ctx, JSValueConst value);
+JSValue      papyrus_value_to_js(JSContext* ctx, const PapyrusValue& value);
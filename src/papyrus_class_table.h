@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "quickjs.h"
+
+// JS classes implementing Papyrus scripts for one context (Papyrus.registerClass)
+//
+// Each class keeps one JS object per bound Papyrus object, keyed by its VM object handle, and
+// each member-native dispatch slot caches the class method that implements it, so a call does
+// no name lookups. The VM reuses the handles of deleted dynamic (0xFF) references, so each
+// instance also remembers the game object it was built for and is rebuilt for any other.
+// Instances of objects that no longer exist are only dropped by sweep().
+class PapyrusClassTable {
+public:
+    struct Method {
+        JSValueConst function;
+        size_t       class_index;
+    };
+
+    // Registers `constructor` for `script`, replacing any class registered for it before along
+    // with its instances and method bindings; returns the index to bind methods to
+    size_t set_class(JSContext* ctx, std::string_view script, JSValueConst constructor);
+    void   set_method(JSContext* ctx, size_t slot, size_t class_index, JSValueConst function);
+
+    std::optional<Method> method(size_t slot) const;
+
+    // The object bound to `handle` for the game object `object`, constructed as
+    // `new Class(self)` on first use; returns a new reference, or JS_EXCEPTION when the
+    // constructor throws. When the constructor replaces the class, the new object is returned
+    // for this call but not kept.
+    JSValue instance(
+        JSContext* ctx, size_t class_index, uint64_t handle, const void* object, JSValueConst self
+    );
+
+    // Drops every instance `keep(handle, object)` rejects; returns how many were dropped
+    size_t sweep(JSContext* ctx, bool (*keep)(uint64_t handle, const void* object));
+
+    void   clear(JSContext* ctx);
+    size_t class_count() const { return classes_.size(); }
+    size_t instance_count() const;
+
+private:
+    struct Instance {
+        const void* object;  // the game object `value` was constructed for
+        JSValue     value;
+    };
+
+    struct Class {
+        std::string                            script;  // lowercased
+        JSValue                                constructor = JS_UNDEFINED;
+        std::unordered_map<uint64_t, Instance> instances;  // by VM object handle
+    };
+
+    struct SlotMethod {
+        JSValue function    = JS_UNDEFINED;
+        size_t  class_index = 0;
+    };
+
+    std::vector<Class>      classes_;
+    std::vector<SlotMethod> methods_;  // by dispatch slot
+};
@@ -0,0 +1,652 @@
+#include "papyrus_interpreter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <limits>
+
+namespace {
+    // Operand slots that are not locals
+    constexpr int32_t operand_literal  = -1;
+    constexpr int32_t operand_self     = -2;
+    constexpr int32_t operand_none     = -3;  // ::NoneVar when it is not declared as a local
+    constexpr int32_t operand_variable = -4;  // object variable of the running script
+
+    // The game's VM also gives up at a fixed depth; this keeps deep recursion off the C++ stack
+    constexpr int max_call_depth = 512;
+
+    // array_create accepts 1..128 elements, like the compiled `new Type[n]`
+    constexpr int32_t max_array_size = 128;
+
+    std::string lowercase(std::string_view str) {
+        std::string result(str);
+        for (auto& c : result) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    int compare_nocase(std::string_view a, std::string_view b) {
+        for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+            int x = tolower(static_cast<unsigned char>(a[i]));
+            int y = tolower(static_cast<unsigned char>(b[i]));
+            if (x != y) return x < y ? -1 : 1;
+        }
+        return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+    }
+
+    using InstanceRef = std::shared_ptr<PexInstance>;
+    using ArrayRef    = std::shared_ptr<PexArray>;
+
+    bool is_none(const PexValue& value) {
+        if (std::holds_alternative<std::monostate>(value)) return true;
+        if (auto* instance = std::get_if<InstanceRef>(&value)) return !*instance;
+        if (auto* array = std::get_if<ArrayRef>(&value)) return !*array;
+        return false;
+    }
+
+    bool is_numeric(const PexValue& value) {
+        return std::holds_alternative<int32_t>(value) || std::holds_alternative<float>(value);
+    }
+
+    int32_t wrap(uint32_t value) { return static_cast<int32_t>(value); }
+
+    int32_t to_int(const PexValue& value) {
+        if (auto* i = std::get_if<int32_t>(&value)) return *i;
+        if (auto* f = std::get_if<float>(&value)) {
+            if (std::isnan(*f)) return 0;
+            if (*f >= 2147483647.0f) return std::numeric_limits<int32_t>::max();
+            if (*f <= -2147483648.0f) return std::numeric_limits<int32_t>::min();
+            return static_cast<int32_t>(*f);
+        }
+        if (auto* b = std::get_if<bool>(&value)) return *b ? 1 : 0;
+        if (auto* s = std::get_if<std::string>(&value)) {
+            long long parsed = strtoll(s->c_str(), nullptr, 10);
+            return static_cast<int32_t>(std::clamp<long long>(
+                parsed, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()
+            ));
+        }
+        return 0;
+    }
+
+    float to_float(const PexValue& value) {
+        if (auto* f = std::get_if<float>(&value)) return *f;
+        if (auto* i = std::get_if<int32_t>(&value)) return static_cast<float>(*i);
+        if (auto* b = std::get_if<bool>(&value)) return *b ? 1.0f : 0.0f;
+        if (auto* s = std::get_if<std::string>(&value)) return strtof(s->c_str(), nullptr);
+        return 0.0f;
+    }
+
+    bool to_bool(const PexValue& value) {
+        if (auto* b = std::get_if<bool>(&value)) return *b;
+        if (auto* i = std::get_if<int32_t>(&value)) return *i != 0;
+        if (auto* f = std::get_if<float>(&value)) return *f != 0.0f;
+        if (auto* s = std::get_if<std::string>(&value)) return !s->empty();
+        if (auto* array = std::get_if<ArrayRef>(&value))
+            return *array && !(*array)->elements.empty();
+        return !is_none(value);
+    }
+
+    bool equals(const PexValue& a, const PexValue& b) {
+        if (is_none(a) || is_none(b)) return is_none(a) && is_none(b);
+        if (is_numeric(a) && is_numeric(b)) {
+            if (std::holds_alternative<int32_t>(a) && std::holds_alternative<int32_t>(b))
+                return std::get<int32_t>(a) == std::get<int32_t>(b);
+            return to_float(a) == to_float(b);
+        }
+        if (std::holds_alternative<std::string>(a) || std::holds_alternative<std::string>(b))
+            return compare_nocase(pex_value_to_string(a), pex_value_to_string(b)) == 0;
+        if (std::holds_alternative<bool>(a) || std::holds_alternative<bool>(b))
+            return to_bool(a) == to_bool(b);
+        return a == b;  // same object or array
+    }
+
+    // Ordering for cmp_lt and friends: numbers numerically, anything else as strings
+    int compare(const PexValue& a, const PexValue& b) {
+        if (std::holds_alternative<int32_t>(a) && std::holds_alternative<int32_t>(b)) {
+            auto x = std::get<int32_t>(a), y = std::get<int32_t>(b);
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+        if (is_numeric(a) || is_numeric(b)) {
+            auto x = to_float(a), y = to_float(b);
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+        return compare_nocase(pex_value_to_string(a), pex_value_to_string(b));
+    }
+
+    PexValue default_value(std::string_view type) {
+        if (type == "int") return int32_t{0};
+        if (type == "float") return 0.0f;
+        if (type == "bool") return false;
+        if (type == "string") return std::string{};
+        return {};
+    }
+
+    PexValue literal(const PexFile& file, const pex::Value& value) {
+        switch (value.type) {
+            case pex::ValueType::string:
+                return std::string(file.string(value.string_index));
+            case pex::ValueType::integer:
+                return value.integer;
+            case pex::ValueType::float_:
+                return value.float_;
+            case pex::ValueType::boolean:
+                return value.boolean;
+            default:
+                return {};
+        }
+    }
+
+    // The variadic arguments of a call instruction, starting after its `first` fixed operands
+    std::vector<PexValue> call_arguments(
+        const pex::Instruction& instruction, uint32_t first, auto&& read
+    ) {
+        std::vector<PexValue> args;
+        args.reserve(instruction.operand_count - first);
+        for (uint32_t i = first; i < instruction.operand_count; i++)
+            args.push_back(read(instruction.first_operand + i));
+        return args;
+    }
+}
+
+std::string pex_value_to_string(const PexValue& value) {
+    if (is_none(value)) return "None";
+    if (auto* b = std::get_if<bool>(&value)) return *b ? "True" : "False";
+    if (auto* i = std::get_if<int32_t>(&value)) return std::to_string(*i);
+    if (auto* f = std::get_if<float>(&value)) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%f", static_cast<double>(*f));
+        return buffer;
+    }
+    if (auto* s = std::get_if<std::string>(&value)) return *s;
+    if (auto* instance = std::get_if<InstanceRef>(&value)) return "[" + (*instance)->script + "]";
+
+    std::string result = "[";
+    for (const auto& element : std::get<ArrayRef>(value)->elements) {
+        if (result.size() > 1) result += ", ";
+        result += pex_value_to_string(element);
+    }
+    return result + "]";
+}
+
+void PexInterpreter::add_script(const PexFile& file) {
+    for (const auto& object : file.objects()) {
+        auto name      = lowercase(file.string(object.name));
+        scripts_[name] = {&file, &object, name, lowercase(file.string(object.parent))};
+    }
+}
+
+void PexInterpreter::register_native(
+    std::string_view script, std::string_view function, PexNative native
+) {
+    natives_[lowercase(script) + "." + lowercase(function)] = std::move(native);
+}
+
+std::shared_ptr<PexInstance> PexInterpreter::create_instance(std::string_view script) {
+    const Script* most_derived = find_script(lowercase(script));
+    if (!most_derived) return nullptr;
+
+    auto instance    = std::make_shared<PexInstance>();
+    instance->script = most_derived->name;
+    instance->state  = lowercase(most_derived->file->string(most_derived->object->auto_state));
+    for (auto* s = most_derived; s; s = find_script(s->parent)) {
+        for (const auto& variable : s->object->variables) {
+            auto name  = lowercase(s->file->string(variable.name));
+            auto value = literal(*s->file, variable.initial_value);
+            if (variable.initial_value.type == pex::ValueType::none)
+                value = default_value(lowercase(s->file->string(variable.type)));
+            instance->variables[s->name + "." + name] = std::move(value);
+        }
+    }
+    return instance;
+}
+
+PexCallResult PexInterpreter::call_static(
+    std::string_view script, std::string_view function, std::span<const PexValue> args
+) {
+    PexCallResult result;
+    error_.clear();
+    result.ok = call(lowercase(script), {}, function, args, result.value);
+    if (!result.ok) result.error = error_;
+    return result;
+}
+
+PexCallResult PexInterpreter::call_method(
+    const std::shared_ptr<PexInstance>& self, std::string_view function,
+    std::span<const PexValue> args
+) {
+    PexCallResult result;
+    error_.clear();
+    if (!self) {
+        result.error = std::format("cannot call {}() on a None object", function);
+        return result;
+    }
+    result.ok = call(self->script, self, function, args, result.value);
+    if (!result.ok) result.error = error_;
+    return result;
+}
+
+const PexInterpreter::Script* PexInterpreter::find_script(std::string_view name) const {
+    if (name.empty()) return nullptr;
+    auto it = scripts_.find(std::string(name));
+    return it == scripts_.end() ? nullptr : &it->second;
+}
+
+const PexInterpreter::Prepared& PexInterpreter::prepare(
+    const Script& script, const pex::Function& function
+) {
+    auto& entry = prepared_[&function];
+    if (entry) return *entry;
+    entry          = std::make_unique<Prepared>();
+    auto& prepared = *entry;
+
+    std::unordered_map<std::string, int32_t> locals;
+    for (const auto* list : {&function.parameters, &function.locals}) {
+        for (const auto& local : *list) {
+            locals[lowercase(script.file->string(local.name))] =
+                static_cast<int32_t>(prepared.types.size());
+            prepared.types.push_back(lowercase(script.file->string(local.type)));
+        }
+    }
+
+    auto count = function.operands.size();
+    prepared.slots.assign(count, operand_literal);
+    prepared.names.resize(count);
+    prepared.keys.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const auto& operand = function.operands[i];
+        if (operand.type != pex::ValueType::identifier) continue;
+
+        auto name         = lowercase(script.file->string(operand.string_index));
+        auto local        = locals.find(name);
+        prepared.slots[i] = operand_variable;
+        if (local != locals.end()) prepared.slots[i] = local->second;
+        else if (name == "self") prepared.slots[i] = operand_self;
+        else if (name == "::nonevar") prepared.slots[i] = operand_none;
+        else prepared.keys[i] = script.name + "." + name;
+        prepared.names[i] = std::move(name);
+    }
+    return prepared;
+}
+
+bool PexInterpreter::is_a(std::string_view script, std::string_view type) const {
+    for (std::string name(script); !name.empty();) {
+        if (name == type) return true;
+        auto* found = find_script(name);
+        if (!found) return false;
+        name = found->parent;
+    }
+    return false;
+}
+
+PexValue PexInterpreter::cast(const PexValue& value, std::string_view type) const {
+    if (type == "int") return to_int(value);
+    if (type == "float") return to_float(value);
+    if (type == "bool") return to_bool(value);
+    if (type == "string") return pex_value_to_string(value);
+    if (type.ends_with("[]")) return std::holds_alternative<ArrayRef>(value) ? value : PexValue{};
+
+    // Object casts keep the object when it is (or derives from) the type, else give None
+    auto* instance = std::get_if<InstanceRef>(&value);
+    if (instance && *instance && is_a((*instance)->script, type)) return value;
+    return {};
+}
+
+bool PexInterpreter::call(
+    std::string_view script, const PexValue& self, std::string_view function,
+    std::span<const PexValue> args, PexValue& result
+) {
+    auto  name     = lowercase(function);
+    auto* instance = std::get_if<InstanceRef>(&self);
+    auto  state    = instance && *instance ? (*instance)->state : std::string{};
+
+    for (auto* s = find_script(script); s; s = find_script(s->parent)) {
+        const pex::Function* target = nullptr;
+        if (!state.empty()) target = s->file->find_function(*s->object, state, name);
+        if (!target) target = s->file->find_function(*s->object, "", name);
+        if (target) return invoke(*s, *target, self, args, result);
+    }
+
+    // Natives of scripts that were never added (Debug, Utility, ...) only need a registry entry
+    for (std::string s(script); !s.empty();) {
+        if (auto native = natives_.find(s + "." + name); native != natives_.end()) {
+            result = native->second(self, args);
+            return true;
+        }
+        auto* found = find_script(s);
+        if (!found) break;
+        s = found->parent;
+    }
+
+    // ScriptObject's state natives (without the OnEndState/OnBeginState events)
+    if (instance && *instance && name == "getstate") {
+        result = (*instance)->state;
+        return true;
+    }
+    if (instance && *instance && name == "gotostate" && !args.empty()) {
+        (*instance)->state = lowercase(pex_value_to_string(args[0]));
+        result             = {};
+        return true;
+    }
+    return fail(std::format("unknown function {}.{}", script, name));
+}
+
+bool PexInterpreter::invoke(
+    const Script& script, const pex::Function& function, const PexValue& self,
+    std::span<const PexValue> args, PexValue& result
+) {
+    auto name = lowercase(script.file->string(function.name));
+    if (function.is_native()) {
+        auto native = natives_.find(script.name + "." + name);
+        if (native == natives_.end())
+            return fail(std::format("native {}.{} is not registered", script.name, name));
+        result = native->second(self, args);
+        return true;
+    }
+    if (depth_ >= max_call_depth) return fail("stack overflow");
+
+    const auto& prepared = prepare(script, function);
+    Frame       frame{&script, &function, &prepared, self, {}};
+    frame.locals.resize(prepared.types.size());
+    for (size_t i = 0; i < prepared.types.size(); i++) {
+        bool passed     = i < function.parameters.size() && i < args.size();
+        frame.locals[i] = passed ? cast(args[i], prepared.types[i])
+                                 : default_value(prepared.types[i]);
+    }
+
+    depth_++;
+    bool ok = execute(frame, result);
+    depth_--;
+    if (!ok) error_ += std::format("\n    at {}.{}", script.name, name);
+    return ok;
+}
+
+PexValue PexInterpreter::read(const Frame& frame, uint32_t operand) const {
+    int32_t slot = frame.prepared->slots[operand];
+    if (slot >= 0) return frame.locals[slot];
+    switch (slot) {
+        case operand_self:
+            return frame.self;
+        case operand_none:
+            return {};
+        case operand_variable: {
+            auto* instance = std::get_if<InstanceRef>(&frame.self);
+            if (!instance || !*instance) return {};
+            auto found = (*instance)->variables.find(frame.prepared->keys[operand]);
+            return found == (*instance)->variables.end() ? PexValue{} : found->second;
+        }
+        default:
+            return literal(*frame.script->file, frame.function->operands[operand]);
+    }
+}
+
+void PexInterpreter::write(Frame& frame, uint32_t operand, PexValue value) {
+    int32_t slot = frame.prepared->slots[operand];
+    if (slot >= 0) {
+        frame.locals[slot] = std::move(value);
+    } else if (slot == operand_variable) {
+        auto* instance = std::get_if<InstanceRef>(&frame.self);
+        if (instance && *instance)
+            (*instance)->variables[frame.prepared->keys[operand]] = std::move(value);
+    }
+}
+
+std::string PexInterpreter::type_of(const Frame& frame, uint32_t operand) const {
+    int32_t slot = frame.prepared->slots[operand];
+    if (slot >= 0) return frame.prepared->types[slot];
+    if (slot == operand_self) return frame.script->name;
+    if (slot != operand_variable) return {};
+
+    const auto& file = *frame.script->file;
+    for (const auto& variable : frame.script->object->variables) {
+        if (compare_nocase(file.string(variable.name), frame.prepared->names[operand]) == 0)
+            return lowercase(file.string(variable.type));
+    }
+    return {};
+}
+
+bool PexInterpreter::get_property(
+    const PexValue& object, const std::string& name, PexValue& result
+) {
+    auto* instance = std::get_if<InstanceRef>(&object);
+    if (!instance || !*instance)
+        return fail(std::format("cannot get property {} on a None object", name));
+
+    for (auto* s = find_script((*instance)->script); s; s = find_script(s->parent)) {
+        for (const auto& property : s->object->properties) {
+            if (compare_nocase(s->file->string(property.name), name) != 0) continue;
+            if (property.flags & 0x04) {
+                auto variable = lowercase(s->file->string(property.auto_variable));
+                result        = (*instance)->variables[s->name + "." + variable];
+                return true;
+            }
+            if (property.getter < 0) return fail(std::format("property {} is write-only", name));
+            return invoke(*s, s->object->accessors[property.getter], object, {}, result);
+        }
+    }
+    return fail(std::format("unknown property {}.{}", (*instance)->script, name));
+}
+
+bool PexInterpreter::set_property(
+    const PexValue& object, const std::string& name, const PexValue& value
+) {
+    auto* instance = std::get_if<InstanceRef>(&object);
+    if (!instance || !*instance)
+        return fail(std::format("cannot set property {} on a None object", name));
+
+    for (auto* s = find_script((*instance)->script); s; s = find_script(s->parent)) {
+        for (const auto& property : s->object->properties) {
+            if (compare_nocase(s->file->string(property.name), name) != 0) continue;
+            if (property.flags & 0x04) {
+                auto variable = lowercase(s->file->string(property.auto_variable));
+                (*instance)->variables[s->name + "." + variable] =
+                    cast(value, lowercase(s->file->string(property.type)));
+                return true;
+            }
+            if (property.setter < 0) return fail(std::format("property {} is read-only", name));
+            PexValue ignored;
+            return invoke(*s, s->object->accessors[property.setter], object, {&value, 1}, ignored);
+        }
+    }
+    return fail(std::format("unknown property {}.{}", (*instance)->script, name));
+}
+
+bool PexInterpreter::fail(std::string message) {
+    error_ = std::move(message);
+    return false;
+}
+
+// Runtime errors the game would log and step past (None calls, bad indices) abort the call
+// here instead, so the host sees them
+bool PexInterpreter::execute(Frame& frame, PexValue& result) {
+    const auto& instructions = frame.function->instructions;
+    const auto& names        = frame.prepared->names;
+    auto        in           = [&](uint32_t operand) { return read(frame, operand); };
+
+    for (int64_t pc = 0; pc < static_cast<int64_t>(instructions.size());) {
+        const auto& instruction = instructions[pc];
+        uint32_t    op          = instruction.first_operand;
+        int64_t     next        = pc + 1;
+        instructions_executed_++;
+
+        switch (instruction.opcode) {
+            using enum pex::Opcode;
+            case nop:
+                break;
+            case iadd:
+                write(frame, op, wrap(uint32_t(to_int(in(op + 1))) + uint32_t(to_int(in(op + 2)))));
+                break;
+            case isub:
+                write(frame, op, wrap(uint32_t(to_int(in(op + 1))) - uint32_t(to_int(in(op + 2)))));
+                break;
+            case imul:
+                write(frame, op, wrap(uint32_t(to_int(in(op + 1))) * uint32_t(to_int(in(op + 2)))));
+                break;
+            case idiv:
+            case imod: {
+                int32_t a = to_int(in(op + 1)), b = to_int(in(op + 2));
+                if (b == 0) return fail("integer division by zero");
+                if (b == -1) {
+                    // INT_MIN / -1 wraps instead of trapping
+                    write(frame, op, instruction.opcode == idiv ? wrap(0u - uint32_t(a)) : 0);
+                    break;
+                }
+                write(frame, op, instruction.opcode == idiv ? a / b : a % b);
+                break;
+            }
+            case fadd:
+                write(frame, op, to_float(in(op + 1)) + to_float(in(op + 2)));
+                break;
+            case fsub:
+                write(frame, op, to_float(in(op + 1)) - to_float(in(op + 2)));
+                break;
+            case fmul:
+                write(frame, op, to_float(in(op + 1)) * to_float(in(op + 2)));
+                break;
+            case fdiv:
+                write(frame, op, to_float(in(op + 1)) / to_float(in(op + 2)));
+                break;
+            case not_:
+                write(frame, op, !to_bool(in(op + 1)));
+                break;
+            case ineg:
+                write(frame, op, wrap(0u - uint32_t(to_int(in(op + 1)))));
+                break;
+            case fneg:
+                write(frame, op, -to_float(in(op + 1)));
+                break;
+            case assign:
+                write(frame, op, in(op + 1));
+                break;
+            case cast:
+                write(frame, op, this->cast(in(op + 1), type_of(frame, op)));
+                break;
+            case cmp_eq:
+                write(frame, op, equals(in(op + 1), in(op + 2)));
+                break;
+            case cmp_lt:
+                write(frame, op, compare(in(op + 1), in(op + 2)) < 0);
+                break;
+            case cmp_le:
+                write(frame, op, compare(in(op + 1), in(op + 2)) <= 0);
+                break;
+            case cmp_gt:
+                write(frame, op, compare(in(op + 1), in(op + 2)) > 0);
+                break;
+            case cmp_ge:
+                write(frame, op, compare(in(op + 1), in(op + 2)) >= 0);
+                break;
+            case jmp:
+                next = pc + to_int(in(op));
+                break;
+            case jmpt:
+                if (to_bool(in(op))) next = pc + to_int(in(op + 1));
+                break;
+            case jmpf:
+                if (!to_bool(in(op))) next = pc + to_int(in(op + 1));
+                break;
+            case callmethod: {
+                auto self = in(op + 1);
+                auto* instance = std::get_if<InstanceRef>(&self);
+                if (!instance || !*instance)
+                    return fail(std::format("cannot call {}() on a None object", names[op]));
+                auto     args = call_arguments(instruction, 3, in);
+                PexValue returned;
+                if (!call((*instance)->script, self, names[op], args, returned)) return false;
+                write(frame, op + 2, std::move(returned));
+                break;
+            }
+            case callparent: {
+                auto     args = call_arguments(instruction, 2, in);
+                PexValue returned;
+                if (!call(frame.script->parent, frame.self, names[op], args, returned))
+                    return false;
+                write(frame, op + 1, std::move(returned));
+                break;
+            }
+            case callstatic: {
+                auto     args = call_arguments(instruction, 3, in);
+                PexValue returned;
+                if (!call(names[op], {}, names[op + 1], args, returned)) return false;
+                write(frame, op + 2, std::move(returned));
+                break;
+            }
+            case return_:
+                result = in(op);
+                return true;
+            case strcat:
+                write(frame, op, pex_value_to_string(in(op + 1)) + pex_value_to_string(in(op + 2)));
+                break;
+            case propget: {
+                PexValue value;
+                if (!get_property(in(op + 1), names[op], value)) return false;
+                write(frame, op + 2, std::move(value));
+                break;
+            }
+            case propset:
+                if (!set_property(in(op + 1), names[op], in(op + 2))) return false;
+                break;
+            case array_create: {
+                int32_t size = to_int(in(op + 1));
+                if (size < 1 || size > max_array_size)
+                    return fail(std::format("array size {} is out of range", size));
+                auto type  = type_of(frame, op);
+                auto array = std::make_shared<PexArray>();
+                array->elements.assign(
+                    size, default_value(std::string_view(type).substr(0, type.size() - 2))
+                );
+                write(frame, op, std::move(array));
+                break;
+            }
+            case array_length: {
+                auto value = in(op + 1);
+                auto* array = std::get_if<ArrayRef>(&value);
+                write(frame, op, array && *array ? int32_t((*array)->elements.size()) : 0);
+                break;
+            }
+            case array_getelement:
+            case array_setelement: {
+                bool  get   = instruction.opcode == array_getelement;
+                auto  value = in(get ? op + 1 : op);
+                auto* array = std::get_if<ArrayRef>(&value);
+                if (!array || !*array) return fail("array access on a None array");
+                int32_t index = to_int(in(op + (get ? 2 : 1)));
+                if (index < 0 || index >= int32_t((*array)->elements.size()))
+                    return fail(std::format("array index {} is out of range", index));
+                if (get) write(frame, op, (*array)->elements[index]);
+                else (*array)->elements[index] = in(op + 2);
+                break;
+            }
+            case array_findelement:
+            case array_rfindelement: {
+                auto  value = in(op);
+                auto* array = std::get_if<ArrayRef>(&value);
+                if (!array || !*array) return fail("array search on a None array");
+                const auto& elements = (*array)->elements;
+                auto        needle   = in(op + 2);
+                int32_t     start    = to_int(in(op + 3));
+                int32_t     found    = -1;
+                int32_t     count    = static_cast<int32_t>(elements.size());
+                if (instruction.opcode == array_findelement) {
+                    for (int32_t i = std::max(start, 0); i < count && found < 0; i++)
+                        if (equals(elements[i], needle)) found = i;
+                } else {
+                    // rfind counts from the end when the start index is negative
+                    int32_t from = start < 0 ? count - 1 : std::min(start, count - 1);
+                    for (int32_t i = from; i >= 0 && found < 0; i--)
+                        if (equals(elements[i], needle)) found = i;
+                }
+                write(frame, op + 1, found);
+                break;
+            }
+        }
+
+        if (next < 0 || next > static_cast<int64_t>(instructions.size()))
+            return fail(std::format("jump to {} is outside the function", next));
+        pc = next;
+    }
+
+    result = {};
+    return true;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "pex_file.h"
+
+// Reference interpreter for compiled Papyrus, so scripts can run outside the game
+//
+// Executes parsed .pex functions opcode by opcode with Papyrus semantics (32-bit wrapping
+// integers, case-insensitive names and string comparison, None-safe casts). Natives come from
+// a registry the host fills in; nothing here touches the game, so it builds into host tools.
+
+struct PexInstance;
+struct PexArray;
+
+using PexValue = std::variant<
+    std::monostate, bool, int32_t, float, std::string, std::shared_ptr<PexInstance>,
+    std::shared_ptr<PexArray>>;
+
+struct PexArray {
+    std::vector<PexValue> elements;
+};
+
+// A script object created by PexInterpreter::create_instance
+struct PexInstance {
+    std::string                               script;  // lowercased
+    std::string                               state;   // lowercased, "" is the empty state
+    std::unordered_map<std::string, PexValue> variables;
+};
+
+struct PexCallResult {
+    bool        ok = false;
+    PexValue    value;
+    std::string error;
+};
+
+// `self` is None for global natives
+using PexNative = std::function<PexValue(const PexValue& self, std::span<const PexValue> args)>;
+
+// Papyrus string conversion ("True", "1.500000", "None", ...)
+std::string pex_value_to_string(const PexValue& value);
+
+class PexInterpreter {
+public:
+    // Makes every object in `file` callable; the file must outlive the interpreter
+    void add_script(const PexFile& file);
+
+    // Natives are looked up by (case-insensitive) script and function name
+    void register_native(std::string_view script, std::string_view function, PexNative native);
+
+    // Creates an object of `script` with its (and its parents') variables initialized; nullptr
+    // when no script with that name was added
+    std::shared_ptr<PexInstance> create_instance(std::string_view script);
+
+    PexCallResult call_static(
+        std::string_view script, std::string_view function, std::span<const PexValue> args
+    );
+    PexCallResult call_method(
+        const std::shared_ptr<PexInstance>& self, std::string_view function,
+        std::span<const PexValue> args
+    );
+
+    uint64_t instructions_executed() const { return instructions_executed_; }
+
+private:
+    struct Script {
+        const PexFile*     file;
+        const pex::Object* object;
+        std::string        name;    // lowercased
+        std::string        parent;  // lowercased, "" at the root
+    };
+
+    // Operands of a function resolved once to local slots, `self`, object variables or literals
+    struct Prepared {
+        std::vector<int32_t>     slots;  // per operand
+        std::vector<std::string> names;  // per operand, lowercased identifier
+        std::vector<std::string> keys;   // per operand, "script.variable" for object variables
+        std::vector<std::string> types;  // per local slot (parameters first), lowercased
+    };
+
+    struct Frame {
+        const Script*         script;
+        const pex::Function*  function;
+        const Prepared*       prepared;
+        PexValue              self;
+        std::vector<PexValue> locals;
+    };
+
+    const Script*   find_script(std::string_view name) const;
+    const Prepared& prepare(const Script& script, const pex::Function& function);
+
+    bool     is_a(std::string_view script, std::string_view type) const;
+    PexValue cast(const PexValue& value, std::string_view type) const;
+
+    bool call(
+        std::string_view script, const PexValue& self, std::string_view function,
+        std::span<const PexValue> args, PexValue& result
+    );
+    bool invoke(
+        const Script& script, const pex::Function& function, const PexValue& self,
+        std::span<const PexValue> args, PexValue& result
+    );
+    bool execute(Frame& frame, PexValue& result);
+    bool get_property(const PexValue& object, const std::string& name, PexValue& result);
+    bool set_property(const PexValue& object, const std::string& name, const PexValue& value);
+
+    PexValue read(const Frame& frame, uint32_t operand) const;
+    void     write(Frame& frame, uint32_t operand, PexValue value);
+
+    std::string type_of(const Frame& frame, uint32_t operand) const;
+
+    bool fail(std::string message);
+
+    std::unordered_map<std::string, Script>                             scripts_;
+    std::unordered_map<std::string, PexNative>                          natives_;  // "script.fn"
+    std::unordered_map<const pex::Function*, std::unique_ptr<Prepared>> prepared_;
+    std::string                                                         error_;
+    int                                                                 depth_ = 0;
+    uint64_t instructions_executed_                                            = 0;
+};
@@ -0,0 +1,103 @@
+#include "papyrus_latent.h"
+
+#include <mutex>
+#include <vector>
+
+#include "context_state.h"
+#include "frame_pump.h"
+#include "js_entry.h"
+#include "js_atoms.h"
+
+namespace {
+    std::mutex                resume_mutex;
+    std::vector<LatentResume> resume_queue;
+
+    // Frame pump step: hand finished results back to their suspended Papyrus stacks
+    void resume_latent_calls() {
+        std::vector<LatentResume> resumes;
+        {
+            std::lock_guard lock(resume_mutex);
+            resumes.swap(resume_queue);
+        }
+        if (resumes.empty()) return;
+
+        auto* vm = RE::BSScript::Internal::VirtualMachine::GetSingleton();
+        if (!vm) {
+            // Keep them for a later frame; dropping them would leave the stacks suspended
+            std::lock_guard lock(resume_mutex);
+            resume_queue.insert(
+                resume_queue.begin(), std::make_move_iterator(resumes.begin()),
+                std::make_move_iterator(resumes.end())
+            );
+            request_frame_pump();
+            return;
+        }
+        // Resumes are arbitrary callbacks, so they are serialized with JS like every native entry
+        JSEntryLock lock;
+        for (auto& resume : resumes) resume(vm);
+    }
+}
+
+void PendingLatentCalls::await(JSContext* ctx, JSValueConst result, Settle settle) {
+    if (!JS_IsPromise(result)) return settle(ctx, result, LatentOutcome::fulfilled);
+
+    uint64_t id = next_id_++;
+    pending_.emplace(id, std::move(settle));
+
+    JSValue data       = JS_NewInt64(ctx, static_cast<int64_t>(id));
+    JSValue handlers[] = {
+        JS_NewCFunctionData(ctx, on_settled, 1, 1, 1, &data),
+        JS_NewCFunctionData(ctx, on_settled, 1, 0, 1, &data),
+    };
+    JSValue then    = js_get_property(ctx, result, JSAtomName::then);
+    JSValue chained = JS_Call(ctx, then, result, 2, handlers);
+    if (JS_IsException(chained)) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        if (auto it = pending_.find(id); it != pending_.end()) {
+            auto settle_now = std::move(it->second);
+            pending_.erase(it);
+            settle_now(ctx, JS_UNDEFINED, LatentOutcome::cancelled);
+        }
+    }
+    JS_FreeValue(ctx, chained);
+    JS_FreeValue(ctx, then);
+    for (auto& handler : handlers) JS_FreeValue(ctx, handler);
+}
+
+JSValue PendingLatentCalls::on_settled(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv, int magic, JSValue* data
+) {
+    auto* state = get_context_state(ctx);
+    if (!state) return JS_UNDEFINED;
+
+    int64_t id = 0;
+    JS_ToInt64(ctx, &id, data[0]);
+
+    auto& pending = state->latent_calls.pending_;
+    auto  it      = pending.find(static_cast<uint64_t>(id));
+    if (it == pending.end()) return JS_UNDEFINED;
+
+    auto settle = std::move(it->second);
+    pending.erase(it);
+    settle(
+        ctx, argc > 0 ? argv[0] : JS_UNDEFINED,
+        magic ? LatentOutcome::fulfilled : LatentOutcome::rejected
+    );
+    return JS_UNDEFINED;
+}
+
+void PendingLatentCalls::clear(JSContext* ctx) {
+    auto pending = std::move(pending_);
+    pending_.clear();
+    for (auto& [id, settle] : pending) settle(ctx, JS_UNDEFINED, LatentOutcome::cancelled);
+}
+
+void queue_latent_resume(LatentResume resume) {
+    {
+        std::lock_guard lock(resume_mutex);
+        resume_queue.push_back(std::move(resume));
+    }
+    request_frame_pump();
+}
+
+void register_papyrus_latent_pump() { add_frame_pump_step(resume_latent_calls); }
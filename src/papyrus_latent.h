@@ -0,0 +1,48 @@
+#pragma once
+
+#include <SkyrimScripting/Plugin.h>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+#include "quickjs.h"
+
+// Latent Papyrus natives implemented by JS async functions
+//
+// The native's thunk calls the JS handler and returns straight away, leaving the Papyrus stack
+// suspended. When the handler's promise settles (its jobs run from the frame pump like any
+// other), the converted result is queued and the stack is resumed from the next pump on the
+// main thread via ReturnLatentResult.
+
+enum class LatentOutcome { fulfilled, rejected, cancelled };
+
+// JS results still waiting to resume a suspended Papyrus stack, one per latent call
+class PendingLatentCalls {
+public:
+    using Settle = std::function<void(JSContext* ctx, JSValueConst value, LatentOutcome outcome)>;
+
+    // Calls `settle` once `result` settles; plain (non-promise) values settle immediately
+    void await(JSContext* ctx, JSValueConst result, Settle settle);
+
+    // Cancels every pending call so no Papyrus stack is left suspended (used at teardown)
+    void   clear(JSContext* ctx);
+    size_t size() const { return pending_.size(); }
+
+private:
+    static JSValue on_settled(
+        JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv, int magic,
+        JSValue* data
+    );
+
+    uint64_t                             next_id_ = 1;
+    std::unordered_map<uint64_t, Settle> pending_;
+};
+
+using LatentResume = std::function<void(RE::BSScript::Internal::VirtualMachine* vm)>;
+
+// Queues `resume` to run on the main thread in the next frame pump (callable from any thread)
+void queue_latent_resume(LatentResume resume);
+
+// Adds the resume step to the frame pump (call once at plugin load)
+void register_papyrus_latent_pump();
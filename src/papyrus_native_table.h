@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "quickjs.h"
+
+// JS implementations of the declared Papyrus natives for one context, indexed by dispatch slot
+class PapyrusNativeTable {
+public:
+    void         set(JSContext* ctx, size_t slot, JSValueConst handler);
+    JSValueConst get(size_t slot) const;
+    void         clear(JSContext* ctx);
+    size_t       size() const;
+
+private:
+    std::vector<JSValue> handlers_;
+};
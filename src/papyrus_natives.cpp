@@ -0,0 +1,17 @@
+#include "papyrus_bridge.h"
+
+// Papyrus natives declared in Scripts/Source that are implemented by JS (one slot each)
+//
+// The slot enum, declaration table and thunks are generated from the .psc files at build time
+// by xmake/modules/papyrus_bindings.lua; adding a native only needs its .psc declaration.
+
+#include "papyrus_natives.generated.h"
+
+std::span<const PapyrusNativeDeclaration> papyrus_native_declarations() {
+    return papyrus_natives_generated::declarations;
+}
+
+bool register_papyrus_natives(RE::BSScript::IVirtualMachine* vm) {
+    papyrus_natives_generated::register_natives(vm);
+    return true;
+}
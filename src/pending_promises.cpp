@@ -0,0 +1,34 @@
+#include "pending_promises.h"
+
+JSValue PendingPromises::create(JSContext* ctx, uint64_t id) {
+    JSValue resolving_funcs[2];
+    JSValue promise = JS_NewPromiseCapability(ctx, resolving_funcs);
+    if (JS_IsException(promise)) return promise;
+    promises_[id] = {resolving_funcs[0], resolving_funcs[1]};
+    return promise;
+}
+
+bool PendingPromises::settle(JSContext* ctx, uint64_t id, bool ok, JSValue value) {
+    auto it = promises_.find(id);
+    if (it == promises_.end()) {
+        JS_FreeValue(ctx, value);
+        return false;
+    }
+
+    auto    funcs  = it->second;
+    JSValue result = JS_Call(ctx, ok ? funcs.resolve : funcs.reject, JS_UNDEFINED, 1, &value);
+    JS_FreeValue(ctx, result);
+    JS_FreeValue(ctx, value);
+    JS_FreeValue(ctx, funcs.resolve);
+    JS_FreeValue(ctx, funcs.reject);
+    promises_.erase(it);
+    return true;
+}
+
+void PendingPromises::clear(JSContext* ctx) {
+    for (auto& [id, funcs] : promises_) {
+        JS_FreeValue(ctx, funcs.resolve);
+        JS_FreeValue(ctx, funcs.reject);
+    }
+    promises_.clear();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "quickjs.h"
+
+// Promises handed to JS whose results arrive later from native code, keyed by request id
+class PendingPromises {
+public:
+    // Creates a promise for request `id` and returns it (or an exception value)
+    JSValue create(JSContext* ctx, uint64_t id);
+
+    // Resolves (or rejects) the promise for `id`, taking ownership of `value`; returns false and
+    // frees `value` when the id is unknown, e.g. because it belonged to an earlier context
+    bool settle(JSContext* ctx, uint64_t id, bool ok, JSValue value);
+
+    void   clear(JSContext* ctx);
+    size_t size() const { return promises_.size(); }
+
+private:
+    struct ResolvingFunctions {
+        JSValue resolve;
+        JSValue reject;
+    };
+
+    std::unordered_map<uint64_t, ResolvingFunctions> promises_;
+};
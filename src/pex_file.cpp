@@ -0,0 +1,325 @@
+#include "pex_file.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <thread>
+
+namespace {
+    constexpr std::array<pex::OpcodeInfo, pex::opcode_count> opcodes{{
+        {"nop", 0, false},
+        {"iadd", 3, false},
+        {"fadd", 3, false},
+        {"isub", 3, false},
+        {"fsub", 3, false},
+        {"imul", 3, false},
+        {"fmul", 3, false},
+        {"idiv", 3, false},
+        {"fdiv", 3, false},
+        {"imod", 3, false},
+        {"not", 2, false},
+        {"ineg", 2, false},
+        {"fneg", 2, false},
+        {"assign", 2, false},
+        {"cast", 2, false},
+        {"cmp_eq", 3, false},
+        {"cmp_lt", 3, false},
+        {"cmp_le", 3, false},
+        {"cmp_gt", 3, false},
+        {"cmp_ge", 3, false},
+        {"jmp", 1, false},
+        {"jmpt", 2, false},
+        {"jmpf", 2, false},
+        {"callmethod", 3, true},
+        {"callparent", 2, true},
+        {"callstatic", 3, true},
+        {"return", 1, false},
+        {"strcat", 3, false},
+        {"propget", 3, false},
+        {"propset", 3, false},
+        {"array_create", 2, false},
+        {"array_length", 2, false},
+        {"array_getelement", 3, false},
+        {"array_setelement", 3, false},
+        {"array_findelement", 4, false},
+        {"array_rfindelement", 4, false},
+    }};
+
+    // Bounds-checked big-endian cursor over the file; the first failure sticks
+    class Reader {
+    public:
+        explicit Reader(std::span<const uint8_t> data) : data_(data) {}
+
+        bool ok() const { return ok_; }
+
+        template <class T>
+        T read() {
+            T value{};
+            if (!ok_ || data_.size() - offset_ < sizeof(T)) {
+                ok_ = false;
+                return value;
+            }
+            memcpy(&value, data_.data() + offset_, sizeof(T));
+            offset_ += sizeof(T);
+            if constexpr (sizeof(T) > 1 && std::endian::native == std::endian::little) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    value = std::bit_cast<T>(std::byteswap(std::bit_cast<uint32_t>(value)));
+                } else {
+                    value = std::byteswap(value);
+                }
+            }
+            return value;
+        }
+
+        std::string_view read_string() {
+            auto length = read<uint16_t>();
+            if (!ok_ || data_.size() - offset_ < length) {
+                ok_ = false;
+                return {};
+            }
+            std::string_view str(reinterpret_cast<const char*>(data_.data() + offset_), length);
+            offset_ += length;
+            return str;
+        }
+
+        void skip(size_t bytes) {
+            if (data_.size() - offset_ < bytes) ok_ = false;
+            else offset_ += bytes;
+        }
+
+    private:
+        std::span<const uint8_t> data_;
+        size_t                   offset_ = 0;
+        bool                     ok_     = true;
+    };
+
+    bool iequals(std::string_view a, std::string_view b) {
+        return std::ranges::equal(a, b, [](char x, char y) {
+            return tolower(static_cast<unsigned char>(x)) == tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    pex::Value read_value(Reader& reader) {
+        pex::Value value;
+        value.type = static_cast<pex::ValueType>(reader.read<uint8_t>());
+        switch (value.type) {
+            case pex::ValueType::none:
+                break;
+            case pex::ValueType::identifier:
+            case pex::ValueType::string:
+                value.string_index = reader.read<uint16_t>();
+                break;
+            case pex::ValueType::integer:
+                value.integer = reader.read<int32_t>();
+                break;
+            case pex::ValueType::float_:
+                value.float_ = reader.read<float>();
+                break;
+            case pex::ValueType::boolean:
+                value.boolean = reader.read<uint8_t>() != 0;
+                break;
+            default:
+                reader.skip(SIZE_MAX);  // unknown type: fail the parse
+        }
+        return value;
+    }
+
+    std::vector<pex::NamedType> read_named_types(Reader& reader) {
+        std::vector<pex::NamedType> list(reader.read<uint16_t>());
+        for (auto& entry : list) {
+            entry.name = reader.read<uint16_t>();
+            entry.type = reader.read<uint16_t>();
+        }
+        return list;
+    }
+
+    bool read_function(Reader& reader, pex::Function& function) {
+        function.return_type = reader.read<uint16_t>();
+        function.doc_string  = reader.read<uint16_t>();
+        function.user_flags  = reader.read<uint32_t>();
+        function.flags       = reader.read<uint8_t>();
+        function.parameters  = read_named_types(reader);
+        function.locals      = read_named_types(reader);
+
+        uint16_t instruction_count = reader.read<uint16_t>();
+        function.instructions.reserve(instruction_count);
+        function.operands.reserve(instruction_count * 3);
+        for (uint16_t i = 0; i < instruction_count && reader.ok(); i++) {
+            auto opcode = reader.read<uint8_t>();
+            if (opcode >= pex::opcode_count) return false;
+
+            const auto&      info = opcodes[opcode];
+            pex::Instruction instruction{
+                .opcode        = static_cast<pex::Opcode>(opcode),
+                .first_operand = static_cast<uint32_t>(function.operands.size()),
+                .operand_count = info.operands,
+            };
+            for (uint8_t j = 0; j < info.operands; j++)
+                function.operands.push_back(read_value(reader));
+
+            if (info.variadic) {
+                pex::Value count = read_value(reader);
+                if (count.type != pex::ValueType::integer || count.integer < 0) return false;
+                for (int32_t j = 0; j < count.integer && reader.ok(); j++)
+                    function.operands.push_back(read_value(reader));
+                instruction.operand_count += static_cast<uint16_t>(count.integer);
+            }
+            function.instructions.push_back(instruction);
+        }
+        return reader.ok();
+    }
+
+    bool read_object(Reader& reader, pex::Object& object) {
+        object.name = reader.read<uint16_t>();
+        reader.read<uint32_t>();  // size of the object data
+        object.parent     = reader.read<uint16_t>();
+        object.doc_string = reader.read<uint16_t>();
+        object.user_flags = reader.read<uint32_t>();
+        object.auto_state = reader.read<uint16_t>();
+
+        object.variables.resize(reader.read<uint16_t>());
+        for (auto& variable : object.variables) {
+            variable.name          = reader.read<uint16_t>();
+            variable.type          = reader.read<uint16_t>();
+            variable.user_flags    = reader.read<uint32_t>();
+            variable.initial_value = read_value(reader);
+        }
+
+        object.properties.resize(reader.read<uint16_t>());
+        for (auto& property : object.properties) {
+            property.name       = reader.read<uint16_t>();
+            property.type       = reader.read<uint16_t>();
+            property.doc_string = reader.read<uint16_t>();
+            property.user_flags = reader.read<uint32_t>();
+            property.flags      = reader.read<uint8_t>();
+            if (property.flags & 0x04) {
+                property.auto_variable = reader.read<uint16_t>();
+                continue;
+            }
+            if (property.flags & 0x01) {
+                property.getter = static_cast<int32_t>(object.accessors.size());
+                if (!read_function(reader, object.accessors.emplace_back())) return false;
+            }
+            if (property.flags & 0x02) {
+                property.setter = static_cast<int32_t>(object.accessors.size());
+                if (!read_function(reader, object.accessors.emplace_back())) return false;
+            }
+        }
+
+        object.states.resize(reader.read<uint16_t>());
+        for (auto& state : object.states) {
+            state.name = reader.read<uint16_t>();
+            state.functions.resize(reader.read<uint16_t>());
+            for (auto& function : state.functions) {
+                function.name = reader.read<uint16_t>();
+                if (!read_function(reader, function)) return false;
+            }
+        }
+        return reader.ok();
+    }
+}
+
+const pex::OpcodeInfo& pex::opcode_info(Opcode opcode) {
+    return opcodes[static_cast<size_t>(opcode)];
+}
+
+bool PexFile::load(const std::filesystem::path& path) {
+    if (!file_.open(path)) {
+        error_ = file_.error();
+        return false;
+    }
+    return parse(file_.data());
+}
+
+bool PexFile::parse(std::span<const uint8_t> data) {
+    Reader reader(data);
+    error_.clear();
+    strings_.clear();
+    objects_.clear();
+
+    if (reader.read<uint32_t>() != pex::magic) {
+        error_ = "not a Skyrim .pex file";
+        return false;
+    }
+    header_.major_version    = reader.read<uint8_t>();
+    header_.minor_version    = reader.read<uint8_t>();
+    header_.game_id          = reader.read<uint16_t>();
+    header_.compilation_time = reader.read<uint64_t>();
+    header_.source_file      = reader.read_string();
+    header_.user             = reader.read_string();
+    header_.machine          = reader.read_string();
+
+    strings_.resize(reader.read<uint16_t>());
+    for (auto& str : strings_) str = reader.read_string();
+
+    // Debug info is not needed for execution, only skipped
+    if (reader.read<uint8_t>()) {
+        reader.read<uint64_t>();  // modification time
+        uint16_t function_count = reader.read<uint16_t>();
+        for (uint16_t i = 0; i < function_count && reader.ok(); i++) {
+            reader.skip(2 + 2 + 2 + 1);  // object, state, function, function type
+            reader.skip(size_t{reader.read<uint16_t>()} * 2);  // line numbers
+        }
+    }
+
+    uint16_t user_flag_count = reader.read<uint16_t>();
+    reader.skip(size_t{user_flag_count} * 3);
+
+    objects_.resize(reader.read<uint16_t>());
+    for (auto& object : objects_) {
+        if (!read_object(reader, object)) {
+            error_ = "invalid object data";
+            return false;
+        }
+    }
+
+    if (!reader.ok()) {
+        error_ = "truncated file";
+        return false;
+    }
+    return true;
+}
+
+const pex::Function* PexFile::find_function(
+    const pex::Object& object, std::string_view state, std::string_view function
+) const {
+    for (const auto& s : object.states) {
+        if (!iequals(string(s.name), state)) continue;
+        for (const auto& f : s.functions) {
+            if (iequals(string(f.name), function)) return &f;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<PexDirectoryEntry> load_pex_directory(
+    const std::filesystem::path& directory, unsigned threads
+) {
+    std::vector<PexDirectoryEntry> entries;
+    std::error_code                ec;
+    for (const auto& item : std::filesystem::directory_iterator(directory, ec)) {
+        if (!item.is_regular_file(ec)) continue;
+        auto extension = item.path().extension().string();
+        if (!iequals(extension, ".pex")) continue;
+        entries.push_back({item.path(), std::make_unique<PexFile>()});
+    }
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, static_cast<unsigned>(entries.size()));
+
+    // Workers pull the next unparsed file, so one large script does not hold up a whole slice
+    std::atomic<size_t> next = 0;
+    auto                work = [&] {
+        for (size_t i = next++; i < entries.size(); i = next++)
+            entries[i].ok = entries[i].file->load(entries[i].path);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+    return entries;
+}
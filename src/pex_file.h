@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mapped_file.h"
+
+// Reader for compiled Papyrus scripts (.pex, Skyrim's big-endian layout)
+//
+// Strings are string_views into the mapped file and everything else refers to them by string
+// table index, so a parsed PexFile must stay alive (and keep its mapping) while they are used.
+
+namespace pex {
+    constexpr uint32_t magic = 0xFA57C0DE;
+
+    enum class Opcode : uint8_t {
+        nop,
+        iadd,
+        fadd,
+        isub,
+        fsub,
+        imul,
+        fmul,
+        idiv,
+        fdiv,
+        imod,
+        not_,
+        ineg,
+        fneg,
+        assign,
+        cast,
+        cmp_eq,
+        cmp_lt,
+        cmp_le,
+        cmp_gt,
+        cmp_ge,
+        jmp,
+        jmpt,
+        jmpf,
+        callmethod,
+        callparent,
+        callstatic,
+        return_,
+        strcat,
+        propget,
+        propset,
+        array_create,
+        array_length,
+        array_getelement,
+        array_setelement,
+        array_findelement,
+        array_rfindelement,
+    };
+    constexpr size_t opcode_count = static_cast<size_t>(Opcode::array_rfindelement) + 1;
+
+    // Fixed operand count of each opcode; the call opcodes are followed by a variable list
+    struct OpcodeInfo {
+        std::string_view name;
+        uint8_t          operands;
+        bool             variadic;
+    };
+    const OpcodeInfo& opcode_info(Opcode opcode);
+
+    enum class ValueType : uint8_t { none, identifier, string, integer, float_, boolean };
+
+    // An instruction operand or variable initial value
+    struct Value {
+        ValueType type = ValueType::none;
+        union {
+            uint16_t string_index;  // identifier / string
+            int32_t  integer;
+            float    float_;
+            bool     boolean;
+        };
+
+        Value() : integer(0) {}
+    };
+
+    struct Instruction {
+        Opcode   opcode;
+        uint32_t first_operand;  // index into Function::operands
+        uint16_t operand_count;  // fixed operands followed by any variadic arguments
+    };
+
+    struct NamedType {
+        uint16_t name;
+        uint16_t type;
+    };
+
+    struct Function {
+        uint16_t                 name        = 0;  // 0 for property accessors (see Property)
+        uint16_t                 return_type = 0;
+        uint16_t                 doc_string  = 0;
+        uint32_t                 user_flags  = 0;
+        uint8_t                  flags       = 0;
+        std::vector<NamedType>   parameters;
+        std::vector<NamedType>   locals;
+        std::vector<Instruction> instructions;
+        std::vector<Value>       operands;
+
+        bool is_global() const { return flags & 0x01; }
+        bool is_native() const { return flags & 0x02; }
+
+        std::span<const Value> operands_of(const Instruction& instruction) const {
+            return {operands.data() + instruction.first_operand, instruction.operand_count};
+        }
+    };
+
+    struct Variable {
+        uint16_t name;
+        uint16_t type;
+        uint32_t user_flags;
+        Value    initial_value;
+    };
+
+    struct Property {
+        uint16_t name;
+        uint16_t type;
+        uint16_t doc_string;
+        uint32_t user_flags;
+        uint8_t  flags;          // 1 = read, 2 = write, 4 = auto variable
+        uint16_t auto_variable;  // when flags & 4
+        int32_t  getter = -1;    // index into Object::accessors
+        int32_t  setter = -1;
+    };
+
+    struct State {
+        uint16_t              name;
+        std::vector<Function> functions;
+    };
+
+    struct Object {
+        uint16_t              name;
+        uint16_t              parent;
+        uint16_t              doc_string;
+        uint32_t              user_flags;
+        uint16_t              auto_state;
+        std::vector<Variable> variables;
+        std::vector<Property> properties;
+        std::vector<Function> accessors;  // property getters/setters
+        std::vector<State>    states;
+    };
+
+    struct Header {
+        uint8_t          major_version    = 0;
+        uint8_t          minor_version    = 0;
+        uint16_t         game_id          = 0;
+        uint64_t         compilation_time = 0;
+        std::string_view source_file;
+        std::string_view user;
+        std::string_view machine;
+    };
+}
+
+class PexFile {
+public:
+    // Maps and parses `path`; on failure error() says why
+    bool load(const std::filesystem::path& path);
+
+    // Parses a buffer the caller keeps alive for the lifetime of this object
+    bool parse(std::span<const uint8_t> data);
+
+    const pex::Header&                   header() const { return header_; }
+    const std::vector<std::string_view>& strings() const { return strings_; }
+    const std::vector<pex::Object>&      objects() const { return objects_; }
+    const std::string&                   error() const { return error_; }
+
+    std::string_view string(uint16_t index) const {
+        return index < strings_.size() ? strings_[index] : std::string_view{};
+    }
+
+    // Looks a function up by (case-insensitive) name in `state` ("" is the empty/default state)
+    const pex::Function* find_function(
+        const pex::Object& object, std::string_view state, std::string_view function
+    ) const;
+
+private:
+    MappedFile                    file_;
+    pex::Header                   header_;
+    std::vector<std::string_view> strings_;
+    std::vector<pex::Object>      objects_;
+    std::string                   error_;
+};
+
+struct PexDirectoryEntry {
+    std::filesystem::path    path;
+    std::unique_ptr<PexFile> file;  // always set; check file->error() when load failed
+    bool                     ok = false;
+};
+
+// Parses every .pex file in `directory` using up to `threads` workers (0 = all cores)
+std::vector<PexDirectoryEntry> load_pex_directory(
+    const std::filesystem::path& directory, unsigned threads = 0
+);
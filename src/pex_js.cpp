@@ -0,0 +1,272 @@
+#include "pex_js.h"
+
+#include <chrono>
+
+#include "js_atoms.h"
+#include "js_marshal.h"
+#include "pex_transpiler.h"
+
+namespace {
+    bool read_option(JSContext* ctx, JSValueConst options, const char* name) {
+        if (!JS_IsObject(options)) return false;
+        JSValue value   = JS_GetPropertyStr(ctx, options, name);
+        bool    enabled = JS_ToBool(ctx, value) > 0;
+        JS_FreeValue(ctx, value);
+        return enabled;
+    }
+
+    // Loads `path` and transpiles its script object; throws and returns empty on failure
+    std::string transpile_file(JSContext* ctx, int argc, JSValueConst* argv, const char* usage) {
+        std::string path;
+        if (argc < 1 || !from_js(ctx, argv[0], path)) {
+            JS_ThrowTypeError(ctx, "%s", usage);
+            return {};
+        }
+
+        PexFile file;
+        if (!file.load(path)) {
+            JS_ThrowInternalError(ctx, "%s: %s", path.c_str(), file.error().c_str());
+            return {};
+        }
+        if (file.objects().empty()) {
+            JS_ThrowInternalError(ctx, "%s: no script object", path.c_str());
+            return {};
+        }
+
+        PexTranspileOptions options{.async_calls = argc > 1 && read_option(ctx, argv[1], "async")};
+        return transpile_pex_object(file, file.objects().front(), options);
+    }
+
+    JSValue named_types_to_js(
+        JSContext* ctx, const PexFile& file, const std::vector<pex::NamedType>& list
+    ) {
+        JSValue array = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < list.size(); i++) {
+            JSValue entry = JS_NewObject(ctx);
+            js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, file.string(list[i].name)));
+            js_set_property(ctx, entry, JSAtomName::type, to_js(ctx, file.string(list[i].type)));
+            JS_SetPropertyUint32(ctx, array, i, entry);
+        }
+        return array;
+    }
+
+    // Identifiers become strings, string literals { string }, None null
+    JSValue value_to_js(JSContext* ctx, const PexFile& file, const pex::Value& value) {
+        switch (value.type) {
+            case pex::ValueType::identifier:
+                return to_js(ctx, file.string(value.string_index));
+            case pex::ValueType::string: {
+                JSValue literal = JS_NewObject(ctx);
+                JS_SetPropertyStr(
+                    ctx, literal, "string", to_js(ctx, file.string(value.string_index))
+                );
+                return literal;
+            }
+            case pex::ValueType::integer:
+                return JS_NewInt32(ctx, value.integer);
+            case pex::ValueType::float_:
+                return JS_NewFloat64(ctx, value.float_);
+            case pex::ValueType::boolean:
+                return JS_NewBool(ctx, value.boolean);
+            default:
+                return JS_NULL;
+        }
+    }
+
+    JSValue function_to_js(
+        JSContext* ctx, const PexFile& file, const pex::Function& function, bool with_code
+    ) {
+        JSValue obj = JS_NewObject(ctx);
+        js_set_property(ctx, obj, JSAtomName::name, to_js(ctx, file.string(function.name)));
+        JS_SetPropertyStr(ctx, obj, "returnType", to_js(ctx, file.string(function.return_type)));
+        JS_SetPropertyStr(ctx, obj, "global", JS_NewBool(ctx, function.is_global()));
+        JS_SetPropertyStr(ctx, obj, "native", JS_NewBool(ctx, function.is_native()));
+        JS_SetPropertyStr(
+            ctx, obj, "parameters", named_types_to_js(ctx, file, function.parameters)
+        );
+        JS_SetPropertyStr(ctx, obj, "locals", named_types_to_js(ctx, file, function.locals));
+        JS_SetPropertyStr(
+            ctx, obj, "instructionCount", to_js(ctx, uint32_t(function.instructions.size()))
+        );
+        if (!with_code) return obj;
+
+        JSValue code = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < function.instructions.size(); i++) {
+            const auto& instruction = function.instructions[i];
+            JSValue     entry       = JS_NewObject(ctx);
+            js_set_property(
+                ctx, entry, JSAtomName::op, to_js(ctx, pex::opcode_info(instruction.opcode).name)
+            );
+            JSValue args     = JS_NewArray(ctx);
+            auto    operands = function.operands_of(instruction);
+            for (uint32_t j = 0; j < operands.size(); j++)
+                JS_SetPropertyUint32(ctx, args, j, value_to_js(ctx, file, operands[j]));
+            js_set_property(ctx, entry, JSAtomName::args, args);
+            JS_SetPropertyUint32(ctx, code, i, entry);
+        }
+        JS_SetPropertyStr(ctx, obj, "code", code);
+        return obj;
+    }
+
+    JSValue object_to_js(
+        JSContext* ctx, const PexFile& file, const pex::Object& object, bool with_code
+    ) {
+        JSValue obj = JS_NewObject(ctx);
+        js_set_property(ctx, obj, JSAtomName::name, to_js(ctx, file.string(object.name)));
+        JS_SetPropertyStr(ctx, obj, "parent", to_js(ctx, file.string(object.parent)));
+        JS_SetPropertyStr(ctx, obj, "autoState", to_js(ctx, file.string(object.auto_state)));
+
+        JSValue variables = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < object.variables.size(); i++) {
+            const auto& variable = object.variables[i];
+            JSValue     entry    = JS_NewObject(ctx);
+            js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, file.string(variable.name)));
+            js_set_property(ctx, entry, JSAtomName::type, to_js(ctx, file.string(variable.type)));
+            JS_SetPropertyStr(
+                ctx, entry, "initialValue", value_to_js(ctx, file, variable.initial_value)
+            );
+            JS_SetPropertyUint32(ctx, variables, i, entry);
+        }
+        JS_SetPropertyStr(ctx, obj, "variables", variables);
+
+        JSValue properties = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < object.properties.size(); i++) {
+            const auto& property = object.properties[i];
+            JSValue     entry    = JS_NewObject(ctx);
+            js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, file.string(property.name)));
+            js_set_property(ctx, entry, JSAtomName::type, to_js(ctx, file.string(property.type)));
+            if (property.flags & 0x04) {
+                JS_SetPropertyStr(
+                    ctx, entry, "autoVariable", to_js(ctx, file.string(property.auto_variable))
+                );
+            }
+            JS_SetPropertyUint32(ctx, properties, i, entry);
+        }
+        JS_SetPropertyStr(ctx, obj, "properties", properties);
+
+        JSValue states = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < object.states.size(); i++) {
+            const auto& state     = object.states[i];
+            JSValue     entry     = JS_NewObject(ctx);
+            JSValue     functions = JS_NewArray(ctx);
+            for (uint32_t j = 0; j < state.functions.size(); j++) {
+                JS_SetPropertyUint32(
+                    ctx, functions, j, function_to_js(ctx, file, state.functions[j], with_code)
+                );
+            }
+            js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, file.string(state.name)));
+            JS_SetPropertyStr(ctx, entry, "functions", functions);
+            JS_SetPropertyUint32(ctx, states, i, entry);
+        }
+        JS_SetPropertyStr(ctx, obj, "states", states);
+        return obj;
+    }
+}
+
+JSValue pex_file_to_js(JSContext* ctx, const PexFile& file, bool with_code) {
+    const auto& header = file.header();
+    JSValue     obj    = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, obj, "source", to_js(ctx, header.source_file));
+    JS_SetPropertyStr(ctx, obj, "user", to_js(ctx, header.user));
+    JS_SetPropertyStr(ctx, obj, "machine", to_js(ctx, header.machine));
+    JS_SetPropertyStr(ctx, obj, "compiledAt", JS_NewFloat64(ctx, double(header.compilation_time)));
+    JS_SetPropertyStr(ctx, obj, "stringCount", to_js(ctx, uint32_t(file.strings().size())));
+
+    JSValue objects = JS_NewArray(ctx);
+    for (uint32_t i = 0; i < file.objects().size(); i++) {
+        JS_SetPropertyUint32(
+            ctx, objects, i, object_to_js(ctx, file, file.objects()[i], with_code)
+        );
+    }
+    JS_SetPropertyStr(ctx, obj, "objects", objects);
+    return obj;
+}
+
+JSValue js_pex_parse(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    std::string path;
+    if (argc < 1 || !from_js(ctx, argv[0], path))
+        return JS_ThrowTypeError(ctx, "parse expects a file path");
+
+    PexFile file;
+    if (!file.load(path))
+        return JS_ThrowInternalError(ctx, "%s: %s", path.c_str(), file.error().c_str());
+    return pex_file_to_js(ctx, file, argc > 1 && read_option(ctx, argv[1], "code"));
+}
+
+JSValue js_pex_parse_directory(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+) {
+    std::string path;
+    if (argc < 1 || !from_js(ctx, argv[0], path))
+        return JS_ThrowTypeError(ctx, "parseDirectory expects a folder path");
+
+    uint32_t threads = 0;
+    if (argc > 1 && JS_IsObject(argv[1])) {
+        JSValue value = JS_GetPropertyStr(ctx, argv[1], "threads");
+        if (!JS_IsUndefined(value)) from_js(ctx, value, threads);
+        JS_FreeValue(ctx, value);
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    auto entries = load_pex_directory(path, threads);
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started
+    );
+
+    uint32_t parsed = 0, objects = 0, functions = 0, instructions = 0;
+    JSValue  failures = JS_NewArray(ctx);
+    uint32_t failed   = 0;
+    for (const auto& entry : entries) {
+        if (!entry.ok) {
+            JSValue failure = JS_NewObject(ctx);
+            JS_SetPropertyStr(ctx, failure, "path", to_js(ctx, entry.path.string()));
+            JS_SetPropertyStr(ctx, failure, "error", to_js(ctx, entry.file->error()));
+            JS_SetPropertyUint32(ctx, failures, failed++, failure);
+            continue;
+        }
+        parsed++;
+        for (const auto& object : entry.file->objects()) {
+            objects++;
+            for (const auto& state : object.states) {
+                functions += static_cast<uint32_t>(state.functions.size());
+                for (const auto& function : state.functions)
+                    instructions += static_cast<uint32_t>(function.instructions.size());
+            }
+        }
+    }
+
+    JSValue result = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, result, "files", to_js(ctx, parsed));
+    JS_SetPropertyStr(ctx, result, "objects", to_js(ctx, objects));
+    JS_SetPropertyStr(ctx, result, "functions", to_js(ctx, functions));
+    JS_SetPropertyStr(ctx, result, "instructions", to_js(ctx, instructions));
+    JS_SetPropertyStr(ctx, result, "milliseconds", to_js(ctx, elapsed.count()));
+    JS_SetPropertyStr(ctx, result, "failures", failures);
+    return result;
+}
+
+JSValue js_pex_transpile(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    auto source = transpile_file(ctx, argc, argv, "transpile expects a file path");
+    if (source.empty()) return JS_EXCEPTION;
+    return to_js(ctx, source);
+}
+
+JSValue js_pex_compile(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    auto source = transpile_file(ctx, argc, argv, "compile expects a file path");
+    if (source.empty()) return JS_EXCEPTION;
+    return JS_Eval(ctx, source.c_str(), source.size(), "<pex-transpiled>", JS_EVAL_TYPE_GLOBAL);
+}
+
+JSValue js_pex_runtime(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    auto    source  = pex_runtime_source();
+    JSValue factory = JS_Eval(
+        ctx, std::string(source).c_str(), source.size(), "<pex-runtime>", JS_EVAL_TYPE_GLOBAL
+    );
+    if (JS_IsException(factory)) return factory;
+
+    JSValue overrides = argc > 0 ? JS_DupValue(ctx, argv[0]) : JS_NewObject(ctx);
+    JSValue runtime   = JS_Call(ctx, factory, JS_UNDEFINED, 1, &overrides);
+    JS_FreeValue(ctx, overrides);
+    JS_FreeValue(ctx, factory);
+    return runtime;
+}
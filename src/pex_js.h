@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pex_file.h"
+#include "quickjs.h"
+
+// Plain-object view of a parsed .pex file; instruction listings are included when `with_code`
+JSValue pex_file_to_js(JSContext* ctx, const PexFile& file, bool with_code);
+
+// Pex.parse(path, { code }) parses one .pex file
+JSValue js_pex_parse(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+
+// Pex.parseDirectory(path, { threads }) parses every .pex file in a folder in parallel and
+// returns totals, failures and the elapsed time
+JSValue js_pex_parse_directory(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+);
+
+// Pex.transpile(path, { async }) returns the script translated to JavaScript source, an
+// expression evaluating to { name, parent, autoState, states }
+JSValue js_pex_transpile(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+
+// Pex.compile(path, { async }) evaluates the transpiled script and returns the object
+JSValue js_pex_compile(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+
+// Pex.runtime(overrides) builds the `rt` helper object that transpiled functions take first
+JSValue js_pex_runtime(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
@@ -0,0 +1,515 @@
+#include "pex_transpiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <set>
+#include <unordered_map>
+
+namespace {
+    std::string lowercase(std::string_view str) {
+        std::string result(str);
+        for (auto& c : result) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    std::string js_string(std::string_view str) {
+        std::string result = "\"";
+        for (unsigned char c : str) {
+            switch (c) {
+                case '"':
+                    result += "\\\"";
+                    break;
+                case '\\':
+                    result += "\\\\";
+                    break;
+                case '\n':
+                    result += "\\n";
+                    break;
+                case '\r':
+                    result += "\\r";
+                    break;
+                case '\t':
+                    result += "\\t";
+                    break;
+                default:
+                    if (c < 0x20) result += std::format("\\x{:02x}", c);
+                    else result += static_cast<char>(c);
+            }
+        }
+        return result + "\"";
+    }
+
+    // JS name for a Papyrus local or parameter; the prefix keeps clear of JS reserved words
+    std::string js_variable(std::string_view papyrus_name) {
+        std::string name = "v_";
+        for (char c : lowercase(papyrus_name)) {
+            bool ok = isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+            name += c == ':' ? '$' : (ok ? c : '_');
+        }
+        return name;
+    }
+
+    std::string default_value(std::string_view type) {
+        if (type.ends_with("[]")) return "null";
+        if (type == "int" || type == "float") return "0";
+        if (type == "bool") return "false";
+        if (type == "string") return "\"\"";
+        return "null";
+    }
+
+    class FunctionWriter {
+    public:
+        FunctionWriter(
+            const PexFile& file, const pex::Object& object, const pex::Function& function,
+            const PexTranspileOptions& options
+        )
+            : file_(file), object_(object), function_(function), options_(options) {
+            for (const auto& variable : object.variables)
+                object_variables_[lowercase(file.string(variable.name))] =
+                    lowercase(file.string(variable.type));
+            for (const auto& parameter : function.parameters)
+                locals_[lowercase(file.string(parameter.name))] =
+                    lowercase(file.string(parameter.type));
+            for (const auto& local : function.locals)
+                locals_[lowercase(file.string(local.name))] = lowercase(file.string(local.type));
+        }
+
+        std::string write() {
+            std::string out = options_.async_calls ? "async function (rt, self"
+                                                   : "function (rt, self";
+            for (const auto& parameter : function_.parameters)
+                out += ", " + js_variable(file_.string(parameter.name));
+            out += ") {\n";
+
+            for (const auto& local : function_.locals) {
+                out += std::format(
+                    "    let {} = {};\n", js_variable(file_.string(local.name)),
+                    default_value(lowercase(file_.string(local.type)))
+                );
+            }
+            if (std::ranges::any_of(function_.operands, [&](const auto& operand) {
+                    return is_discarded(operand);
+                }))
+                out += "    let discarded;\n";
+
+            collect_jump_targets();
+            if (jump_targets_.empty()) {
+                for (size_t i = 0; i < function_.instructions.size(); i++)
+                    out += "    " + instruction(i) + "\n";
+                out += "    return null;\n";
+            } else {
+                out += "    let pc = 0;\n    for (;;) {\n        switch (pc) {\n";
+                out += "            case 0:\n";
+                for (size_t i = 0; i < function_.instructions.size(); i++) {
+                    if (i != 0 && jump_targets_.contains(i))
+                        out += std::format("            case {}:\n", i);
+                    out += "                " + instruction(i) + "\n";
+                }
+                out += "            default:\n                return null;\n";
+                out += "        }\n    }\n";
+            }
+            return out + "}";
+        }
+
+    private:
+        void collect_jump_targets() {
+            for (size_t i = 0; i < function_.instructions.size(); i++) {
+                const auto& instruction = function_.instructions[i];
+                auto        operands    = function_.operands_of(instruction);
+                switch (instruction.opcode) {
+                    case pex::Opcode::jmp:
+                        jump_targets_.insert(target(i, operands[0]));
+                        break;
+                    case pex::Opcode::jmpt:
+                    case pex::Opcode::jmpf:
+                        jump_targets_.insert(target(i, operands[1]));
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        static size_t target(size_t index, const pex::Value& offset) {
+            return static_cast<size_t>(static_cast<int64_t>(index) + offset.integer);
+        }
+
+        std::string name_of(const pex::Value& value) const {
+            return lowercase(file_.string(value.string_index));
+        }
+
+        // Declared type of an operand (lowercased), or "" when unknown
+        std::string type_of(const pex::Value& value) const {
+            switch (value.type) {
+                case pex::ValueType::integer:
+                    return "int";
+                case pex::ValueType::float_:
+                    return "float";
+                case pex::ValueType::boolean:
+                    return "bool";
+                case pex::ValueType::string:
+                    return "string";
+                case pex::ValueType::identifier: {
+                    auto name = name_of(value);
+                    if (name == "self") return lowercase(file_.string(object_.name));
+                    if (auto it = locals_.find(name); it != locals_.end()) return it->second;
+                    if (auto it = object_variables_.find(name); it != object_variables_.end())
+                        return it->second;
+                    return "";
+                }
+                default:
+                    return "none";
+            }
+        }
+
+        bool is_numeric(const pex::Value& value) const {
+            auto type = type_of(value);
+            return type == "int" || type == "float";
+        }
+
+        // ::NoneVar that is not declared as a local: reads give None and writes are dropped,
+        // as in the interpreter
+        bool is_discarded(const pex::Value& value) const {
+            return value.type == pex::ValueType::identifier && name_of(value) == "::nonevar" &&
+                   !locals_.contains("::nonevar");
+        }
+
+        // An operand written to; discarded results go to a throwaway local
+        std::string destination(const pex::Value& value) const {
+            return is_discarded(value) ? "discarded" : expression(value);
+        }
+
+        std::string expression(const pex::Value& value) const {
+            switch (value.type) {
+                case pex::ValueType::identifier: {
+                    auto name = name_of(value);
+                    if (name == "self") return "self";
+                    if (is_discarded(value)) return "null";
+                    if (locals_.contains(name)) return js_variable(name);
+                    return "self[" + js_string(name) + "]";
+                }
+                case pex::ValueType::string:
+                    return js_string(file_.string(value.string_index));
+                // Negative literals are parenthesized so `-x` and `a - b` stay well-formed
+                case pex::ValueType::integer:
+                    if (value.integer < 0) return "(" + std::to_string(value.integer) + ")";
+                    return std::to_string(value.integer);
+                // Printed exactly, so literals compare equal to the floats the code computes
+                case pex::ValueType::float_: {
+                    if (std::isnan(value.float_)) return "NaN";
+                    if (std::isinf(value.float_))
+                        return value.float_ < 0 ? "(-Infinity)" : "Infinity";
+                    char buffer[32];
+                    snprintf(buffer, sizeof(buffer), "%.17g", static_cast<double>(value.float_));
+                    return std::signbit(value.float_) ? std::format("({})", buffer)
+                                                      : std::string(buffer);
+                }
+                case pex::ValueType::boolean:
+                    return value.boolean ? "true" : "false";
+                default:
+                    return "null";
+            }
+        }
+
+        std::string to_bool(const pex::Value& value) const {
+            if (type_of(value) == "bool") return expression(value);
+            return "rt.toBool(" + expression(value) + ")";
+        }
+
+        // Papyrus string of an operand; floats always print "%f"-style, integral or not
+        std::string to_string(const pex::Value& value) const {
+            auto type = type_of(value);
+            if (type == "string") return expression(value);
+            if (type == "float") return "rt.floatToString(" + expression(value) + ")";
+            return "rt.toString(" + expression(value) + ")";
+        }
+
+        // idiv/imod; only a non-zero literal divisor skips the runtime's division-by-zero check
+        std::string integer_division(std::span<const pex::Value> ops, bool modulo) const {
+            auto divisor = ops[2];
+            if (divisor.type == pex::ValueType::integer && divisor.integer != 0) {
+                return std::format(
+                    "{} = ({} {} {}) | 0;", destination(ops[0]), expression(ops[1]),
+                    modulo ? "%" : "/", expression(divisor)
+                );
+            }
+            return std::format(
+                "{} = rt.{}({}, {});", destination(ops[0]), modulo ? "imod" : "idiv",
+                expression(ops[1]), expression(divisor)
+            );
+        }
+
+        std::string call_args(std::span<const pex::Value> operands, size_t first) const {
+            std::string args = "[";
+            for (size_t i = first; i < operands.size(); i++) {
+                if (i != first) args += ", ";
+                args += expression(operands[i]);
+            }
+            return args + "]";
+        }
+
+        std::string cast_to(const pex::Value& to, const pex::Value& from) const {
+            auto type   = type_of(to);
+            auto source = expression(from);
+            if (type == type_of(from)) return source;
+            if (type == "int") return "rt.toInt(" + source + ")";
+            if (type == "float") return "rt.toFloat(" + source + ")";
+            if (type == "bool") return "rt.toBool(" + source + ")";
+            if (type == "string") return to_string(from);
+            if (type.ends_with("[]")) return source;
+            return std::format("{}rt.castObject({}, {})", awaited(), source, js_string(type));
+        }
+
+        std::string awaited() const { return options_.async_calls ? "await " : ""; }
+
+        std::string instruction(size_t index) const {
+            const auto& instruction = function_.instructions[index];
+            auto        ops         = function_.operands_of(instruction);
+            auto        e           = [&](size_t i) { return expression(ops[i]); };
+            auto        d           = [&](size_t i) { return destination(ops[i]); };
+            auto        jump        = [&](size_t offset_operand) {
+                return std::format("{{ pc = {}; continue; }}", target(index, ops[offset_operand]));
+            };
+
+            using enum pex::Opcode;
+            switch (instruction.opcode) {
+                case nop:
+                    return ";";
+                case iadd:
+                    return std::format("{} = ({} + {}) | 0;", d(0), e(1), e(2));
+                case isub:
+                    return std::format("{} = ({} - {}) | 0;", d(0), e(1), e(2));
+                case imul:
+                    return std::format("{} = Math.imul({}, {});", d(0), e(1), e(2));
+                case idiv:
+                    return integer_division(ops, false);
+                case imod:
+                    return integer_division(ops, true);
+                case fadd:
+                    return std::format("{} = Math.fround({} + {});", d(0), e(1), e(2));
+                case fsub:
+                    return std::format("{} = Math.fround({} - {});", d(0), e(1), e(2));
+                case fmul:
+                    return std::format("{} = Math.fround({} * {});", d(0), e(1), e(2));
+                case fdiv:
+                    return std::format("{} = Math.fround({} / {});", d(0), e(1), e(2));
+                case not_:
+                    return std::format("{} = !{};", d(0), to_bool(ops[1]));
+                case ineg:
+                    return std::format("{} = (-{}) | 0;", d(0), e(1));
+                case fneg:
+                    return std::format("{} = -{};", d(0), e(1));
+                case assign:
+                    return std::format("{} = {};", d(0), e(1));
+                case cast:
+                    return std::format("{} = {};", d(0), cast_to(ops[0], ops[1]));
+                case cmp_eq:
+                    if (is_numeric(ops[1]) && is_numeric(ops[2]))
+                        return std::format("{} = {} === {};", d(0), e(1), e(2));
+                    return std::format("{} = rt.eq({}, {});", d(0), e(1), e(2));
+                case cmp_lt:
+                case cmp_le:
+                case cmp_gt:
+                case cmp_ge: {
+                    std::string_view op = instruction.opcode == cmp_lt   ? "<"
+                                          : instruction.opcode == cmp_le ? "<="
+                                          : instruction.opcode == cmp_gt ? ">"
+                                                                         : ">=";
+                    if (is_numeric(ops[1]) && is_numeric(ops[2]))
+                        return std::format("{} = {} {} {};", d(0), e(1), op, e(2));
+                    return std::format("{} = rt.compare({}, {}) {} 0;", d(0), e(1), e(2), op);
+                }
+                case jmp:
+                    return jump(0);
+                case jmpt:
+                    return std::format("if ({}) {}", to_bool(ops[0]), jump(1));
+                case jmpf:
+                    return std::format("if (!{}) {}", to_bool(ops[0]), jump(1));
+                case callmethod:
+                    return std::format(
+                        "{} = {}rt.callMethod({}, {}, {});", d(2), awaited(), e(1),
+                        js_string(name_of(ops[0])), call_args(ops, 3)
+                    );
+                case callparent:
+                    return std::format(
+                        "{} = {}rt.callParent(self, {}, {}, {});", d(1), awaited(),
+                        js_string(lowercase(file_.string(object_.parent))),
+                        js_string(name_of(ops[0])), call_args(ops, 2)
+                    );
+                case callstatic:
+                    return std::format(
+                        "{} = {}rt.callStatic({}, {}, {});", d(2), awaited(),
+                        js_string(name_of(ops[0])), js_string(name_of(ops[1])), call_args(ops, 3)
+                    );
+                case return_:
+                    return std::format("return {};", e(0));
+                case strcat:
+                    return std::format(
+                        "{} = {} + {};", d(0), to_string(ops[1]), to_string(ops[2])
+                    );
+                case propget:
+                    return std::format(
+                        "{} = {}rt.getProperty({}, {});", d(2), awaited(), e(1),
+                        js_string(name_of(ops[0]))
+                    );
+                case propset:
+                    return std::format(
+                        "{}rt.setProperty({}, {}, {});", awaited(), e(1),
+                        js_string(name_of(ops[0])), e(2)
+                    );
+                case array_create: {
+                    auto element = type_of(ops[0]);
+                    if (element.ends_with("[]")) element.resize(element.size() - 2);
+                    return std::format(
+                        "{} = rt.newArray({}, {});", d(0), e(1), default_value(element)
+                    );
+                }
+                case array_length:
+                    return std::format("{} = {} === null ? 0 : {}.length;", d(0), e(1), e(1));
+                case array_getelement:
+                    return std::format("{} = rt.getElement({}, {});", d(0), e(1), e(2));
+                case array_setelement:
+                    return std::format("rt.setElement({}, {}, {});", e(0), e(1), e(2));
+                case array_findelement:
+                    return std::format("{} = rt.find({}, {}, {});", d(1), e(0), e(2), e(3));
+                case array_rfindelement:
+                    return std::format("{} = rt.rfind({}, {}, {});", d(1), e(0), e(2), e(3));
+            }
+            return ";";
+        }
+
+        const PexFile&                               file_;
+        const pex::Object&                           object_;
+        const pex::Function&                         function_;
+        const PexTranspileOptions&                   options_;
+        std::unordered_map<std::string, std::string> locals_;  // parameters and locals by name
+        std::unordered_map<std::string, std::string> object_variables_;
+        std::set<size_t>                             jump_targets_;
+    };
+
+    void indent(std::string& out, const std::string& text, std::string_view prefix) {
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            if (start != 0) out += prefix;
+            out.append(text, start, end - start);
+            if (end < text.size()) out += '\n';
+            start = end + 1;
+        }
+    }
+}
+
+std::string transpile_pex_function(
+    const PexFile& file, const pex::Object& object, const pex::Function& function,
+    const PexTranspileOptions& options
+) {
+    return FunctionWriter(file, object, function, options).write();
+}
+
+std::string transpile_pex_object(
+    const PexFile& file, const pex::Object& object, const PexTranspileOptions& options
+) {
+    std::string out = std::format(
+        "({{\n    name: {},\n    parent: {},\n    autoState: {},\n    states: {{\n",
+        js_string(file.string(object.name)), js_string(file.string(object.parent)),
+        js_string(lowercase(file.string(object.auto_state)))
+    );
+    for (const auto& state : object.states) {
+        out += std::format("        {}: {{\n", js_string(lowercase(file.string(state.name))));
+        for (const auto& function : state.functions) {
+            if (function.is_native()) continue;  // natives stay with the game
+            auto name = js_string(lowercase(file.string(function.name)));
+            out += std::format("            {}: ", name);
+            indent(out, transpile_pex_function(file, object, function, options), "            ");
+            out += ",\n";
+        }
+        out += "        },\n";
+    }
+    return out + "    },\n})";
+}
+
+std::string_view pex_runtime_source() {
+    // Papyrus semantics for the helpers the transpiled code calls; string comparisons and
+    // searches are case-insensitive like the Papyrus VM's
+    return R"js((overrides) => {
+    const missing = (name) => () => { throw new Error(`Papyrus runtime has no ${name}`); };
+    const fold = (v) => (typeof v === "string" ? v.toLowerCase() : v);
+    const checkIndex = (array, index) => {
+        if (array === null) throw new Error("array access on a None array");
+        if (index < 0 || index >= array.length)
+            throw new Error(`array index ${index} is out of range`);
+        return index;
+    };
+    const rt = {
+        toBool: (v) => (Array.isArray(v) ? v.length > 0 : Boolean(v)),
+        // Saturating, like the interpreter: NaN is 0 and out-of-range values clamp
+        toInt: (v) => {
+            const n = typeof v === "string" ? parseInt(v, 10) : Number(v);
+            if (Number.isNaN(n)) return 0;
+            return Math.min(Math.max(Math.trunc(n), -2147483648), 2147483647) | 0;
+        },
+        toFloat: (v) => Math.fround(typeof v === "string" ? parseFloat(v) || 0 : Number(v)),
+        toString: (v) => {
+            if (v === null || v === undefined) return "None";
+            if (typeof v === "boolean") return v ? "True" : "False";
+            if (typeof v === "number" && !Number.isInteger(v)) return v.toFixed(6);
+            return String(v);
+        },
+        // printf("%f"): a float times 1e6 is exact in a double, rounded half to even like printf
+        floatToString: (v) => {
+            if (Number.isNaN(v)) return "nan";
+            if (!Number.isFinite(v)) return v > 0 ? "inf" : "-inf";
+            const scaled = Math.abs(v) * 1e6;
+            let units = Math.round(scaled);
+            if (units - scaled === 0.5 && units % 2 === 1) units--;
+            const digits = BigInt(units).toString().padStart(7, "0");
+            const sign = v < 0 || Object.is(v, -0) ? "-" : "";
+            return `${sign}${digits.slice(0, -6)}.${digits.slice(-6)}`;
+        },
+        // The interpreter fails the call on a zero divisor; INT_MIN / -1 wraps through | 0
+        idiv: (a, b) => {
+            if (b === 0) throw new Error("integer division by zero");
+            return (a / b) | 0;
+        },
+        imod: (a, b) => {
+            if (b === 0) throw new Error("integer division by zero");
+            return (a % b) | 0;
+        },
+        eq: (a, b) => fold(a) === fold(b),
+        compare: (a, b) => { a = fold(a); b = fold(b); return a < b ? -1 : a > b ? 1 : 0; },
+        // Array misuse fails the call with the interpreter's messages
+        newArray: (size, value) => {
+            if (size < 1 || size > 128) throw new Error(`array size ${size} is out of range`);
+            return new Array(size).fill(value);
+        },
+        getElement: (array, index) => array[checkIndex(array, index)],
+        setElement: (array, index, value) => {
+            array[checkIndex(array, index)] = value;
+        },
+        find: (array, value, start) => {
+            if (array === null) throw new Error("array search on a None array");
+            for (let i = Math.max(start, 0); i < array.length; i++)
+                if (fold(array[i]) === fold(value)) return i;
+            return -1;
+        },
+        rfind: (array, value, start) => {
+            if (array === null) throw new Error("array search on a None array");
+            const last = array.length - 1;
+            for (let i = start < 0 ? last : Math.min(start, last); i >= 0; i--)
+                if (fold(array[i]) === fold(value)) return i;
+            return -1;
+        },
+        callStatic: missing("callStatic"),
+        callMethod: missing("callMethod"),
+        callParent: missing("callParent"),
+        getProperty: missing("getProperty"),
+        setProperty: missing("setProperty"),
+        castObject: (value) => value,
+    };
+    return Object.assign(rt, overrides);
+})js";
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "pex_file.h"
+
+// Translates compiled Papyrus functions into JavaScript source
+//
+// Each function becomes `function (rt, self, ...params)`; straight-line code is emitted as is and
+// functions with jumps become a `for (;;) switch (pc)` loop with a case per jump target, so the
+// result runs as ordinary QuickJS bytecode. Anything that needs the game (calls, properties,
+// casts to object types) goes through the `rt` object, built from pex_runtime_source().
+//
+// Locals and parameters become JS variables, object variables are properties of `self` keyed by
+// their lowercased Papyrus name. Papyrus names are case-insensitive and are lowercased.
+
+struct PexTranspileOptions {
+    // Emit async functions that await every call/property access (needed when `rt` forwards
+    // to the Papyrus VM, whose results only arrive in a later frame)
+    bool async_calls = false;
+};
+
+std::string transpile_pex_function(
+    const PexFile& file, const pex::Object& object, const pex::Function& function,
+    const PexTranspileOptions& options = {}
+);
+
+// An expression evaluating to { name, parent, autoState, states: { <state>: { <fn>: function } } }
+std::string transpile_pex_object(
+    const PexFile& file, const pex::Object& object, const PexTranspileOptions& options = {}
+);
+
+// An expression evaluating to a function (overrides) => rt that returns the helper object the
+// transpiled code expects; `overrides` supplies callStatic/callMethod/callParent/getProperty/
+// setProperty/castObject, which default to throwing
+std::string_view pex_runtime_source();
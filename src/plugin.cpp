@@ -4,15 +4,46 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <chrono>
+#include <memory_resource>
+#include <optional>
 #include <string>
 #include <unordered_map>
-
+#include <vector>
+
+#include "context_state.h"
+#include "event_log.h"
+#include "frame_pump.h"
+#include "ini_file.h"
+#include "js_entry.h"
+#include "js_forms.h"
+#include "js_jobs.h"
+#include "js_limits.h"
+#include "js_references.h"
+#include "js_world.h"
+#include "memory_usage.h"
+#include "papyrus_bridge.h"
+#include "papyrus_calls.h"
+#include "papyrus_latent.h"
+#include "pex_js.h"
+#include "psc_js.h"
 #include "quickjs.h"
+#include "runtime_state.h"
 
 using namespace std;
 
-// Store dynamically created globals
-unordered_map<string, JSValue> global_vars;
+// Global variables for QuickJS environment
+JSRuntime*  runtime = nullptr;
+JSContext*  context = nullptr;
+std::string input_buffer;
+bool        empty_line_detected = false;
+
+// Per-context memory and stack limits, loaded from the plugin's INI file
+constexpr auto CONFIG_FILE       = "Data/SKSE/Plugins/JavaScriptPapyrusExperiment.ini";
+constexpr auto REPL_CONTEXT_NAME = "repl";
+JSLimitsConfig      limits_config;
+JSMemoryBudget      memory_budget;
+GcSchedulerSettings gc_settings;
 
 // Flag to check if CTRL+C was pressed
 volatile sig_atomic_t ctrl_c_pressed = 0;
@@ -24,9 +55,14 @@ void handle_signal(int signal) {
     }
 }
 
+// Resolvers asked, in order, about globals that are not defined yet
+static const GlobalResolver global_resolvers[] = {
+    resolve_form_global,  // form editor IDs
+};
+
 // C++ function exposed to JS
 JSValue js_lookup_global(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    Log("C++ function called from JS");
+    log_event("C++ function called from JS");
 
     if (argc < 1 || !JS_IsString(argv[0])) {
         return JS_UNDEFINED;
@@ -39,41 +75,38 @@ JSValue js_lookup_global(JSContext* ctx, JSValueConst this_val, int argc, JSValu
     if (!prop_name) {
         return JS_UNDEFINED;
     } else {
-        Log("Looking up global: {}", prop_name);
+        log_event("Looking up global: {}", prop_name);
     }
 
+    auto& globals = get_context_state(ctx)->globals;
+
     // Check if we already created this global
-    auto it = global_vars.find(prop_name);
-    if (it != global_vars.end()) {
+    if (auto existing = globals.find(ctx, {prop_name, len})) {
         JS_FreeCString(ctx, prop_name);
-        return JS_DupValue(ctx, it->second);
+        return *existing;
+    }
+
+    for (auto resolver : global_resolvers) {
+        if (auto value = resolver(ctx, {prop_name, len})) {
+            JSValue new_global = globals.materialize(ctx, {prop_name, len}, *value);
+            JS_FreeCString(ctx, prop_name);
+            return new_global;
+        }
     }
 
     // If the prop name is "MyString" then lazily define a global string with the value "I am a
     // string!"
     if (strcmp(prop_name, "MyString") == 0) {
-        JSValue new_global     = JS_NewString(ctx, "I am a string!");
-        global_vars[prop_name] = JS_DupValue(ctx, new_global);
-
-        // Define on globalThis so it persists
-        JSValue global_obj = JS_GetGlobalObject(ctx);
-        JS_SetPropertyStr(ctx, global_obj, prop_name, JS_DupValue(ctx, new_global));
-        JS_FreeValue(ctx, global_obj);
-
+        JSValue new_global =
+            globals.materialize(ctx, {prop_name, len}, JS_NewString(ctx, "I am a string!"));
         JS_FreeCString(ctx, prop_name);
         return new_global;
     }
 
     // Lazy define it (for example, defaulting to an empty object)
-    JSValue new_global     = JS_UNDEFINED;
-    global_vars[prop_name] = JS_DupValue(ctx, new_global);
+    JSValue new_global = globals.materialize(ctx, {prop_name, len}, JS_UNDEFINED);
 
-    // Define on globalThis so it persists
-    JSValue global_obj = JS_GetGlobalObject(ctx);
-    JS_SetPropertyStr(ctx, global_obj, prop_name, JS_DupValue(ctx, new_global));
-    JS_FreeValue(ctx, global_obj);
-
-    Log("Lazy defined global: {}", prop_name);
+    log_event("Lazy defined global: {}", prop_name);
 
     JS_FreeCString(ctx, prop_name);
     return new_global;
@@ -83,14 +116,33 @@ JSValue js_lookup_global(JSContext* ctx, JSValueConst this_val, int argc, JSValu
 static void js_dump_error(JSContext* ctx) {
     JSValue     exception = JS_GetException(ctx);
     const char* error_msg = JS_ToCString(ctx, exception);
-    Log("Error: {}", error_msg ? error_msg : "unknown");
+    log_event("Error: {}", error_msg ? error_msg : "unknown");
     if (error_msg) JS_FreeCString(ctx, error_msg);
     JS_FreeValue(ctx, exception);
 }
 
+// Log a summary of console output dropped by the context's quota
+static void report_suppressed_console_output(optional<SuppressedConsoleOutput> suppressed) {
+    if (!suppressed) return;
+    log_event(
+        "console: suppressed {} lines ({} bytes) over quota", suppressed->lines, suppressed->bytes
+    );
+    PrintToConsole("[console output over quota: {} lines suppressed]", suppressed->lines);
+}
+
 // Custom console.log implementation
 static JSValue js_console_log(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    string output;
+    auto& quota = get_context_state(ctx)->console_quota;
+    auto  now   = chrono::steady_clock::now();
+    report_suppressed_console_output(quota.take_report(now));
+
+    // Don't bother formatting the arguments if the line would be dropped anyway
+    if (!quota.has_line_budget(now)) {
+        quota.suppress_line();
+        return JS_UNDEFINED;
+    }
+
+    pmr::string output(scratch_memory(ctx));
     for (int i = 0; i < argc; i++) {
         const char* str = JS_ToCString(ctx, argv[i]);
         if (str) {
@@ -99,11 +151,234 @@ static JSValue js_console_log(JSContext* ctx, JSValueConst this_val, int argc, J
         }
         if (i < argc - 1) output += " ";
     }
-    Log("{}", output);
+    if (!quota.admit(output.size(), now)) return JS_UNDEFINED;
+    log_event("{}", output);
     ConsoleLog(output.c_str());
     return JS_UNDEFINED;
 }
 
+// console.event(format, ...args) writes a structured event to the log (not the console)
+//
+// In binary log mode the arguments are stored raw and `{}` placeholders are only substituted by
+// the offline decoder; otherwise the event is formatted here and logged as text.
+static JSValue js_console_event(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+) {
+    if (argc < 1) return JS_UNDEFINED;
+
+    auto& quota = get_context_state(ctx)->console_quota;
+    auto  now   = chrono::steady_clock::now();
+    report_suppressed_console_output(quota.take_report(now));
+    if (!quota.has_line_budget(now)) {
+        quota.suppress_line();
+        return JS_UNDEFINED;
+    }
+
+    size_t      format_len;
+    const char* format = JS_ToCStringLen(ctx, &format_len, argv[0]);
+    if (!format) return JS_EXCEPTION;
+
+    pmr::vector<binary_log::Arg> args(scratch_memory(ctx));
+    pmr::vector<const char*>     strings(scratch_memory(ctx));
+    size_t                       bytes = format_len;
+    args.reserve(argc - 1);
+
+    for (int i = 1; i < argc; i++) {
+        JSValueConst value = argv[i];
+        if (JS_IsBool(value)) {
+            args.emplace_back(JS_ToBool(ctx, value) != 0);
+        } else if (JS_VALUE_GET_TAG(value) == JS_TAG_INT) {
+            args.emplace_back(static_cast<int64_t>(JS_VALUE_GET_INT(value)));
+        } else if (JS_IsNumber(value)) {
+            double number = 0;
+            JS_ToFloat64(ctx, &number, value);
+            args.emplace_back(number);
+        } else if (JS_IsNull(value) || JS_IsUndefined(value)) {
+            args.emplace_back(monostate{});
+        } else {
+            size_t      len;
+            const char* str = JS_ToCStringLen(ctx, &len, value);
+            if (!str) {
+                // A throwing toString(): the exception is the call's result, not the next one's
+                for (auto* collected : strings) JS_FreeCString(ctx, collected);
+                JS_FreeCString(ctx, format);
+                return JS_EXCEPTION;
+            }
+            strings.push_back(str);
+            args.emplace_back(string_view{str, len});
+            bytes += len;
+        }
+    }
+
+    if (quota.admit(bytes, now)) {
+        auto& writer = binary_log_writer();
+        if (writer.is_open()) {
+            writer.write_event(writer.intern_format({format, format_len}), args);
+        } else {
+            Log("{}", binary_log::format_record({format, format_len}, args));
+        }
+    }
+
+    for (auto* str : strings) JS_FreeCString(ctx, str);
+    JS_FreeCString(ctx, format);
+    return JS_UNDEFINED;
+}
+
+// Sizes of the native caches that hold on to values from the context, for memory reports
+static vector<NativeCacheSize> native_cache_sizes(JSContext* ctx) {
+    auto* state = get_context_state(ctx);
+    return {
+        {"globals", state->globals.size(), state->globals.approximate_bytes()},
+        {"scratch_arena", state->scratch.bytes_used(), state->scratch.bytes_reserved()},
+        {"papyrus_natives", state->papyrus_natives.size(), 0},
+        {"papyrus_classes", state->papyrus_classes.class_count(), 0},
+        {"papyrus_instances", state->papyrus_classes.instance_count(), 0},
+        {"latent_calls", state->latent_calls.size(), 0},
+        {"reference_wrappers", get_runtime_state(JS_GetRuntime(ctx))->references.size(), 0},
+        {"form_cache", form_cache_size(), 0},
+    };
+}
+
+// Engine.memoryUsage() returns a breakdown of the runtime's memory usage
+static JSValue js_engine_memory_usage(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+) {
+    return memory_report_to_js(ctx, collect_memory_report(ctx, native_cache_sizes(ctx)));
+}
+
+// Load settings from the config file, keeping the defaults when it is missing
+static void load_config() {
+    IniFile ini;
+    if (!ini.load(CONFIG_FILE)) Log("No config file at {}, using default settings", CONFIG_FILE);
+    limits_config = JSLimitsConfig::from_ini(ini);
+    memory_budget.set_total(limits_config.total_budget);
+    gc_settings = GcSchedulerSettings::from_ini(ini);
+    if (runtime) get_runtime_state(runtime)->gc_scheduler.set_settings(gc_settings);
+    set_papyrus_call_batching(ini.get_number("papyrus", "batch_calls").value_or(1) != 0);
+}
+
+// Apply new limits to a context's runtime, drawing its memory limit from the shared budget;
+// false, with the context's limits unchanged, when the budget has no room left for it
+static bool set_context_limits(JSContext* ctx, JSLimits limits) {
+    auto* state     = get_context_state(ctx);
+    auto  requested = limits.memory_limit;
+
+    auto granted = memory_budget.reserve(state->name, requested);
+    if (!granted) {
+        Log("Context '{}' asked for {} bytes but the memory budget of {} has {} reserved",
+            state->name, requested, memory_budget.total(), memory_budget.reserved());
+        return false;
+    }
+    limits.memory_limit = *granted;
+    if (limits.memory_limit != requested) {
+        Log("Context '{}' asked for {} bytes and was granted {}, what is left in the budget",
+            state->name, requested, limits.memory_limit);
+    }
+
+    apply_js_limits(JS_GetRuntime(ctx), limits);
+    state->globals.set_capacity(ctx, limits.global_registry_capacity);
+    state->limits = limits;
+    state->memory_pressure.rearm();
+    return true;
+}
+
+// Checks whether the pending exception is QuickJS's out-of-memory error, leaving it pending
+static bool is_out_of_memory_exception(JSContext* ctx) {
+    JSValue     exception = JS_GetException(ctx);
+    const char* message   = JS_ToCString(ctx, exception);
+    bool        result    = message && strstr(message, "out of memory");
+    if (message) JS_FreeCString(ctx, message);
+    JS_Throw(ctx, exception);
+    return result;
+}
+
+// Samples the heap the runtime's allocator holds now and raises Engine.onMemoryPressure(info)
+// when usage rises into a pressure level. The allocator's live count is the runtime's current
+// usage without the full heap walk of JS_ComputeMemoryUsage, so it can be sampled every frame.
+static void check_memory_pressure(JSContext* ctx, bool out_of_memory) {
+    auto* state = get_context_state(ctx);
+    auto  used  = get_runtime_state(JS_GetRuntime(ctx))->allocator.stats().bytes_in_use;
+    auto  level = state->memory_pressure.update(used, state->limits, out_of_memory);
+    if (!level) return;
+
+    log_event(
+        "Context '{}' memory {}: {} of {} bytes in use, high-water mark {}", state->name,
+        to_string(*level), used, state->limits.memory_limit,
+        state->memory_pressure.high_water_mark()
+    );
+
+    JSValue global  = JS_GetGlobalObject(ctx);
+    JSValue engine  = JS_GetPropertyStr(ctx, global, "Engine");
+    JSValue handler = JS_GetPropertyStr(ctx, engine, "onMemoryPressure");
+
+    if (JS_IsFunction(ctx, handler)) {
+        JSValue info = JS_NewObject(ctx);
+        JS_SetPropertyStr(ctx, info, "level", JS_NewString(ctx, to_string(*level)));
+        JS_SetPropertyStr(ctx, info, "context", JS_NewString(ctx, state->name.c_str()));
+        JS_SetPropertyStr(ctx, info, "used", JS_NewInt64(ctx, used));
+        JS_SetPropertyStr(
+            ctx, info, "highWaterMark", JS_NewInt64(ctx, state->memory_pressure.high_water_mark())
+        );
+        JS_SetPropertyStr(ctx, info, "limit", JS_NewInt64(ctx, state->limits.memory_limit));
+
+        JSValue result = JS_Call(ctx, handler, engine, 1, &info);
+        if (JS_IsException(result)) js_dump_error(ctx);
+        JS_FreeValue(ctx, result);
+        JS_FreeValue(ctx, info);
+    }
+
+    JS_FreeValue(ctx, handler);
+    JS_FreeValue(ctx, engine);
+    JS_FreeValue(ctx, global);
+}
+
+// Engine.limits() returns the context's current limits, memory use and high-water mark
+static JSValue js_engine_limits(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+) {
+    auto*   state = get_context_state(ctx);
+    JSValue obj   = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, obj, "memoryLimit", JS_NewInt64(ctx, state->limits.memory_limit));
+    JS_SetPropertyStr(ctx, obj, "maxStackSize", JS_NewInt64(ctx, state->limits.max_stack_size));
+    JS_SetPropertyStr(ctx, obj, "warningRatio", JS_NewFloat64(ctx, state->limits.warning_ratio));
+    JS_SetPropertyStr(ctx, obj, "used", JS_NewInt64(ctx, state->memory_pressure.used()));
+    JS_SetPropertyStr(
+        ctx, obj, "highWaterMark", JS_NewInt64(ctx, state->memory_pressure.high_water_mark())
+    );
+    return obj;
+}
+
+// Engine.setLimits({ memoryLimit, maxStackSize, warningRatio }) adjusts the limits at runtime
+static JSValue js_engine_set_limits(
+    JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv
+) {
+    if (argc < 1 || !JS_IsObject(argv[0]))
+        return JS_ThrowTypeError(ctx, "setLimits expects an object");
+
+    JSLimits limits = get_context_state(ctx)->limits;
+
+    auto read_size = [&](const char* name, size_t& out) {
+        JSValue value = JS_GetPropertyStr(ctx, argv[0], name);
+        int64_t number;
+        if (!JS_IsUndefined(value) && JS_ToInt64(ctx, &number, value) == 0 && number > 0)
+            out = static_cast<size_t>(number);
+        JS_FreeValue(ctx, value);
+    };
+    read_size("memoryLimit", limits.memory_limit);
+    read_size("maxStackSize", limits.max_stack_size);
+
+    JSValue ratio = JS_GetPropertyStr(ctx, argv[0], "warningRatio");
+    double  number;
+    if (!JS_IsUndefined(ratio) && JS_ToFloat64(ctx, &number, ratio) == 0 && number > 0 &&
+        number <= 1)
+        limits.warning_ratio = number;
+    JS_FreeValue(ctx, ratio);
+
+    if (!set_context_limits(ctx, limits))
+        return JS_ThrowRangeError(ctx, "setLimits: the memory budget has no room for the limit");
+    return js_engine_limits(ctx, this_val, 0, nullptr);
+}
+
 void setup_js_env(JSContext* ctx) {
     // Get global object
     JSValue global_obj = JS_GetGlobalObject(ctx);
@@ -143,32 +418,199 @@ void setup_js_env(JSContext* ctx) {
     JS_FreeValue(ctx, global_obj);
 }
 
-// Global variables for QuickJS environment
-JSRuntime*  runtime = nullptr;
-JSContext*  context = nullptr;
-std::string input_buffer;
-bool        empty_line_detected = false;
+// What the game is doing right now, judged from the UI's menu stack
+static GameActivity current_game_activity() {
+    auto* ui = RE::UI::GetSingleton();
+    if (!ui) return GameActivity::Gameplay;
+    if (ui->IsMenuOpen(RE::LoadingMenu::MENU_NAME)) return GameActivity::Loading;
+    if (ui->GameIsPaused()) return GameActivity::Menu;
+    return GameActivity::Gameplay;
+}
+
+// Forwards menu open/close events to the runtime's GC scheduler
+class GameActivityEventSink : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+public:
+    RE::BSEventNotifyControl ProcessEvent(
+        const RE::MenuOpenCloseEvent* event, RE::BSTEventSource<RE::MenuOpenCloseEvent>*
+    ) override {
+        JSEntryLock lock;  // the runtime may be torn down on another thread
+        if (!event || !runtime) return RE::BSEventNotifyControl::kContinue;
+        lock.enter(runtime);
+
+        auto activity = current_game_activity();
+
+        // The menu being opened is not necessarily reflected in the UI state yet
+        if (event->opening) {
+            if (event->menuName == RE::LoadingMenu::MENU_NAME) {
+                activity = GameActivity::Loading;
+            } else if (activity == GameActivity::Gameplay) {
+                auto menu = RE::UI::GetSingleton()->GetMenu(event->menuName);
+                if (menu && menu->PausesGame()) activity = GameActivity::Menu;
+            }
+        }
+
+        get_runtime_state(runtime)->gc_scheduler.set_activity(activity);
+        return RE::BSEventNotifyControl::kContinue;
+    }
+};
+
+GameActivityEventSink game_activity_event_sink;
+
+// Frame pump step: run the GC scheduler's collection, if one is due, between frames. Heap growth
+// can come from any entry into JS, so while a runtime exists the step asks for every frame's
+// pump itself; it is first requested when the runtime is created.
+static void run_scheduled_gc() {
+    JSEntryLock lock;
+    if (!runtime) return;
+    lock.enter(runtime);
+    get_runtime_state(runtime)->gc_scheduler.on_frame();
+    request_frame_pump();
+}
+
+// Frame pump step: sample the REPL context's memory pressure, so that allocations made by
+// Papyrus natives and latent callbacks count, and usage is seen to fall after a spike
+static void sample_memory_pressure() {
+    JSEntryLock lock;
+    if (!context) return;
+    lock.enter(runtime);
+    check_memory_pressure(context, false);
+}
+
+// Create a runtime whose allocations come from its own pooled allocator
+JSRuntime* create_js_runtime() {
+    auto* state = new RuntimeState{};
+    auto* rt    = JS_NewRuntime2(&state->allocator.malloc_functions(), &state->allocator);
+    if (!rt) {
+        delete state;
+        return nullptr;
+    }
+    JS_SetRuntimeOpaque(rt, state);
+    register_reference_class(rt);
+    state->gc_scheduler.set_settings(gc_settings);
+    state->gc_scheduler.attach(rt, current_game_activity(), &state->allocator.stats().bytes_in_use);
+    request_frame_pump();  // starts run_scheduled_gc's per-frame pumps
+    return rt;
+}
+
+// Free a runtime created by create_js_runtime, releasing its allocator's slabs in one go
+void destroy_js_runtime(JSRuntime* rt) {
+    auto* state = get_runtime_state(rt);
+    state->gc_scheduler.detach();
+    state->atoms.release(rt);
+    JS_FreeRuntime(rt);
+
+    const auto& stats = state->allocator.stats();
+    Log("JS allocator: peak {} bytes in use, {} allocations ({} large), {} bytes of slabs",
+        stats.peak_bytes_in_use, stats.total_allocations, stats.large_allocations,
+        stats.slab_bytes);
+    delete state;
+}
+
+// Native modules on the global object, defined by static tables so that each function object
+// is only created when a context first reads it
+static const JSCFunctionListEntry console_functions[] = {
+    JS_CFUNC_DEF("log", 1, js_console_log),
+    JS_CFUNC_DEF("event", 1, js_console_event),
+};
+
+static const JSCFunctionListEntry engine_functions[] = {
+    JS_CFUNC_DEF("memoryUsage", 0, js_engine_memory_usage),
+    JS_CFUNC_DEF("limits", 0, js_engine_limits),
+    JS_CFUNC_DEF("setLimits", 1, js_engine_set_limits),
+};
+
+// Implementing Papyrus natives in JS, and calling Papyrus from JS
+static const JSCFunctionListEntry papyrus_functions[] = {
+    js_bind_def<papyrus_register_native>("registerNative"),
+    js_bind_def<papyrus_register_class>("registerClass"),
+    JS_CFUNC_DEF("call", 2, js_papyrus_call),
+    JS_CFUNC_DEF("callMethod", 3, js_papyrus_call_method),
+};
+
+// Cached form lookups
+static const JSCFunctionListEntry form_functions[] = {
+    js_bind_def<form_get>("get"),
+    js_bind_def<form_by_editor_id>("byEditorId"),
+};
+
+// Bits of the flags column of World queries
+static const JSCFunctionListEntry world_flags[] = {
+    JS_PROP_INT32_DEF("disabled", world_flag_disabled, JS_PROP_ENUMERABLE),
+    JS_PROP_INT32_DEF("deleted", world_flag_deleted, JS_PROP_ENUMERABLE),
+    JS_PROP_INT32_DEF("loaded", world_flag_loaded, JS_PROP_ENUMERABLE),
+    JS_PROP_INT32_DEF("actor", world_flag_actor, JS_PROP_ENUMERABLE),
+    JS_PROP_INT32_DEF("dead", world_flag_dead, JS_PROP_ENUMERABLE),
+    JS_PROP_INT32_DEF("inCombat", world_flag_in_combat, JS_PROP_ENUMERABLE),
+};
+
+// World.actors() etc. return { count, formIDs, x, y, z, flags } columns; see js_world.h
+static const JSCFunctionListEntry world_functions[] = {
+    js_bind_def<world_actors>("actors"),
+    js_bind_def<world_references>("references"),
+    js_bind_def<world_references_of_type>("referencesOfType"),
+    JS_OBJECT_DEF("flags", world_flags, size(world_flags), JS_PROP_ENUMERABLE),
+};
+
+// Reading compiled Papyrus scripts
+static const JSCFunctionListEntry pex_functions[] = {
+    JS_CFUNC_DEF("parse", 2, js_pex_parse),
+    JS_CFUNC_DEF("parseDirectory", 2, js_pex_parse_directory),
+    JS_CFUNC_DEF("transpile", 2, js_pex_transpile),
+    JS_CFUNC_DEF("compile", 2, js_pex_compile),
+    JS_CFUNC_DEF("runtime", 1, js_pex_runtime),
+};
+
+// Parsing and indexing Papyrus sources
+static const JSCFunctionListEntry psc_functions[] = {
+    JS_CFUNC_DEF("parse", 1, js_psc_parse),
+    JS_CFUNC_DEF("index", 2, js_psc_index),
+    JS_CFUNC_DEF("find", 1, js_psc_find),
+    JS_CFUNC_DEF("complete", 2, js_psc_complete),
+};
+
+constexpr int module_flags = JS_PROP_WRITABLE | JS_PROP_CONFIGURABLE;
+
+static const JSCFunctionListEntry global_modules[] = {
+    JS_OBJECT_DEF("console", console_functions, size(console_functions), module_flags),
+    JS_OBJECT_DEF("Engine", engine_functions, size(engine_functions), module_flags),
+    JS_OBJECT_DEF("Papyrus", papyrus_functions, size(papyrus_functions), module_flags),
+    JS_OBJECT_DEF("Form", form_functions, size(form_functions), module_flags),
+    JS_OBJECT_DEF("World", world_functions, size(world_functions), module_flags),
+    JS_OBJECT_DEF("Pex", pex_functions, size(pex_functions), module_flags),
+    JS_OBJECT_DEF("Psc", psc_functions, size(psc_functions), module_flags),
+};
 
 // Initialize JS environment
 void initialize_js_environment() {
+    JSEntryLock lock;
+
     // Initialize QuickJS runtime with proper memory limits
-    runtime = JS_NewRuntime();
+    runtime = create_js_runtime();
     if (!runtime) {
         ConsoleLog("Failed to create JS runtime");
         return;
     }
-
-    // Set memory limit (in bytes) to avoid overflow issues
-    JS_SetMemoryLimit(runtime, 64 * 1024 * 1024);  // 64 MB
-
-    // Set maximum stack size
-    JS_SetMaxStackSize(runtime, 1024 * 1024);  // 1 MB
+    lock.enter(runtime);
 
     // Create a JavaScript context
     context = JS_NewContext(runtime);
     if (!context) {
         ConsoleLog("Failed to create JS context");
-        JS_FreeRuntime(runtime);
+        destroy_js_runtime(runtime);
+        runtime = nullptr;
+        return;
+    }
+
+    JS_SetContextOpaque(context, new ContextState{.name = REPL_CONTEXT_NAME});
+    get_runtime_state(runtime)->atoms.init(context);
+
+    // Apply the memory and stack limits configured for this context
+    if (!set_context_limits(context, limits_config.for_context(REPL_CONTEXT_NAME))) {
+        ConsoleLog("Failed to create JS context: the memory budget is used up");
+        destroy_context_state(context);
+        JS_FreeContext(context);
+        destroy_js_runtime(runtime);
+        context = nullptr;
         runtime = nullptr;
         return;
     }
@@ -178,8 +620,10 @@ void initialize_js_environment() {
     if (JS_IsException(global)) {
         ConsoleLog("Failed to get global object");
         js_dump_error(context);
+        memory_budget.release(REPL_CONTEXT_NAME);
+        destroy_context_state(context);
         JS_FreeContext(context);
-        JS_FreeRuntime(runtime);
+        destroy_js_runtime(runtime);
         context = nullptr;
         runtime = nullptr;
         return;
@@ -187,67 +631,103 @@ void initialize_js_environment() {
 
     // Setup custom environment
     setup_js_env(context);
+    setup_reference_class(context);
 
-    // Add a console object with log method
-    JSValue console = JS_NewObject(context);
-    JS_SetPropertyStr(context, console, "log", JS_NewCFunction(context, js_console_log, "log", 1));
-    JS_SetPropertyStr(context, global, "console", console);
+    // Install the native modules from their static function tables
+    JS_SetPropertyFunctionList(context, global, global_modules, size(global_modules));
 
     // Free the global object reference
     JS_FreeValue(context, global);
 
+    // Papyrus natives implemented in JS now dispatch into this context
+    set_papyrus_bridge_context(context);
+
     ConsoleLog("JavaScript environment initialized");
 }
 
 // Cleanup JS environment
 void cleanup_js_environment() {
+    JSEntryLock lock(runtime);
+    set_papyrus_bridge_context(nullptr);
+
     if (context) {
+        if (auto* state = get_context_state(context)) {
+            report_suppressed_console_output(state->console_quota.flush_report());
+            memory_budget.release(state->name);
+        }
+
+        // Release the native caches' references while their context still exists
+        destroy_context_state(context);
         JS_FreeContext(context);
         context = nullptr;
     }
 
     if (runtime) {
-        JS_FreeRuntime(runtime);
+        destroy_js_runtime(runtime);
         runtime = nullptr;
     }
 
     // Clear the input buffer
     input_buffer.clear();
     empty_line_detected = false;
+
+    binary_log_writer().flush();
 }
 
-// Execute the JavaScript code in the input buffer
-void execute_js_code() {
+// Execute the JavaScript code in the input buffer, with the console's selected reference as $ref
+void execute_js_code(RE::TESObjectREFR* selected_reference) {
     if (!context || input_buffer.empty()) return;
 
     PrintToConsole("Executing JavaScript code:");
 
-    std::string wrapped_code =
+    JSEntryLock lock(runtime);
+
+    JSValue global = JS_GetGlobalObject(context);
+    JS_SetPropertyStr(context, global, "$ref", reference_to_js(context, selected_reference));
+    JS_FreeValue(context, global);
+
+    // Native temporaries for this evaluation come from the context's scratch arena
+    auto*        state = get_context_state(context);
+    ScratchScope scratch_scope(state->scratch, state->scratch_depth);
+
+    constexpr string_view wrapper_head =
         "(function() {\n"
         "  try {\n"
-        "    return eval(`" +
-        input_buffer +
+        "    return eval(`";
+    constexpr string_view wrapper_retry =
         "`);\n"
         "  } catch (e) {\n"
         "    if (e instanceof ReferenceError && e.message.includes('is not defined')) {\n"
         "      const varName = e.message.split(' ')[0];\n"
         "      globalThis[varName] = __lookup_global_from_cpp(varName);\n"
         "      // Try again with the defined variable\n"
-        "      return eval(`" +
-        input_buffer +
+        "      return eval(`";
+    constexpr string_view wrapper_tail =
         "`);\n"
         "    }\n"
         "    throw e;\n"
         "  }\n"
         "})()";
 
+    pmr::string wrapped_code(&state->scratch);
+    wrapped_code.reserve(
+        wrapper_head.size() + wrapper_retry.size() + wrapper_tail.size() + 2 * input_buffer.size()
+    );
+    wrapped_code.append(wrapper_head)
+        .append(input_buffer)
+        .append(wrapper_retry)
+        .append(input_buffer)
+        .append(wrapper_tail);
+
     JSValue result = JS_Eval(
         context, wrapped_code.c_str(), wrapped_code.length(), "<skyrim-console>",
         JS_EVAL_TYPE_GLOBAL
     );
 
     // Check for errors
+    bool out_of_memory = false;
     if (JS_IsException(result)) {
+        out_of_memory = is_out_of_memory_exception(context);
         js_dump_error(context);
     } else if (!JS_IsUndefined(result)) {
         // Print the result if it's not undefined
@@ -261,6 +741,15 @@ void execute_js_code() {
     // Free the result value
     JS_FreeValue(context, result);
 
+    // Run any promise callbacks the code queued
+    run_pending_js_jobs(runtime);
+
+    check_memory_pressure(context, out_of_memory);
+
+    report_suppressed_console_output(
+        get_context_state(context)->console_quota.take_report(chrono::steady_clock::now())
+    );
+
     // Reset input buffer after execution
     input_buffer.clear();
 }
@@ -273,16 +762,24 @@ constexpr auto START_REPL_COMMAND = "js";
 constexpr auto END_REPL_COMMAND   = "end";
 constexpr auto QUIT_GAME_COMMAND  = "qqq";
 
+constexpr auto BINARY_LOG_COMMAND = "jslog";
+constexpr auto MEMORY_COMMAND     = "jsmem";
+constexpr auto LIMITS_COMMAND     = "jslimits";
+constexpr auto BINARY_LOG_FILE    = "JavaScriptPapyrusExperiment.jslog";
+
+// Runs `line` as one of the plugin's console commands if it starts with one (defined below)
+static bool run_plugin_command(const std::string& line, RE::TESObjectREFR* reference);
+
 auto onJavaScriptREPLText =
     function_pointer([](const char* commandText, RE::TESObjectREFR* reference) {
-        Log("Received command: {}", commandText);
+        log_event("Received command: {}", commandText);
         if (_isJavaScriptREPLRunning) {
             std::string current_line(commandText);
 
             if (current_line == QUIT_GAME_COMMAND) return false;
 
             if (current_line == END_REPL_COMMAND) {
-                Log("Ending JavaScript REPL...");
+                log_event("Ending JavaScript REPL...");
                 ConsoleLog("Ending JavaScript REPL...");
 
                 // Clean up the JavaScript environment
@@ -293,6 +790,10 @@ auto onJavaScriptREPLText =
                 return true;
             }
 
+            // The REPL owns the console, so the plugin's commands would otherwise reach it as JS;
+            // between snippets they still run as commands, against the REPL's runtime
+            if (input_buffer.empty() && run_plugin_command(current_line, reference)) return true;
+
             // Check if the line is empty or all whitespace
             if (current_line.empty() || current_line == "\r" ||
                 all_of(current_line.begin(), current_line.end(), [](unsigned char c) {
@@ -300,8 +801,8 @@ auto onJavaScriptREPLText =
                 })) {
                 if (empty_line_detected) {
                     // Double newline detected, evaluate the code
-                    Log("Executing JavaScript code: {}", input_buffer);
-                    execute_js_code();
+                    log_event("Executing JavaScript code: {}", input_buffer);
+                    execute_js_code(reference);
                     empty_line_detected = false;
                 } else {
                     empty_line_detected = true;
@@ -310,18 +811,18 @@ auto onJavaScriptREPLText =
                 if (!input_buffer.empty()) input_buffer += "\n";
                 input_buffer += current_line;
                 empty_line_detected = false;
-                Log("{}", current_line);
+                log_event("{}", current_line);
             }
             return true;
         }
-        Log("JavaScript REPL is not running, ignoring command.");
+        log_event("JavaScript REPL is not running, ignoring command.");
         return false;
     });
 
 auto onStartJavaScriptREPL = function_pointer([](const char* command, const char* commandText,
                                                  RE::TESObjectREFR* reference) {
     if (!_isJavaScriptREPLRunning) {
-        Log("Starting JavaScript REPL...");
+        log_event("Starting JavaScript REPL...");
         ConsoleLog("Starting JavaScript REPL...");
 
         // Initialize the JavaScript environment
@@ -345,6 +846,90 @@ auto onStartJavaScriptREPL = function_pointer([](const char* command, const char
     return false;
 });
 
+// jslog binary|text - switches native and console.event logging between text and binary records
+auto onBinaryLogCommand = function_pointer([](const char* command, const char* commandText,
+                                              RE::TESObjectREFR* reference) {
+    string_view text{commandText};
+    string_view mode = text.substr(min(text.size(), text.find_last_of(' ') + 1));
+    auto&       writer = binary_log_writer();
+
+    if (mode == "binary") {
+        auto directory = SKSE::log::log_directory();
+        if (!directory) {
+            ConsoleLog("jslog: SKSE log directory not found");
+            return true;
+        }
+        auto path = *directory / BINARY_LOG_FILE;
+        if (writer.open(path)) {
+            Log("Binary logging enabled: {}", path.string());
+            PrintToConsole("jslog: writing binary log to {}", path.string());
+        } else {
+            PrintToConsole("jslog: failed to open {}", path.string());
+        }
+    } else if (mode == "text") {
+        writer.close();
+        Log("Binary logging disabled");
+        ConsoleLog("jslog: text logging");
+    } else {
+        PrintToConsole(
+            "jslog: {} (usage: jslog binary|text)", writer.is_open() ? "binary" : "text"
+        );
+    }
+    return true;
+});
+
+// jsmem - prints the JS runtime's memory usage breakdown (also typed inside the REPL, which is
+// when a runtime exists)
+auto onMemoryCommand = function_pointer([](const char* command, const char* commandText,
+                                           RE::TESObjectREFR* reference) {
+    JSEntryLock lock(runtime);
+    if (!context) {
+        ConsoleLog("jsmem: no JavaScript runtime is running (start one with 'js')");
+        return true;
+    }
+    for (const auto& line :
+         format_memory_report(collect_memory_report(context, native_cache_sizes(context))))
+        ConsoleLog(line.c_str());
+    return true;
+});
+
+// jslimits [reload] - prints the running context's limits, or reloads them from the config file
+auto onLimitsCommand = function_pointer([](const char* command, const char* commandText,
+                                           RE::TESObjectREFR* reference) {
+    JSEntryLock lock(runtime);
+    if (string_view{commandText}.ends_with("reload")) {
+        load_config();
+        ConsoleLog("jslimits: reloaded config");
+        if (context && !set_context_limits(context, limits_config.for_context(REPL_CONTEXT_NAME)))
+            ConsoleLog("jslimits: no room in the memory budget, keeping the old limits");
+    }
+    if (!context) {
+        ConsoleLog("jslimits: no JavaScript runtime is running (start one with 'js')");
+        return true;
+    }
+    auto* state = get_context_state(context);
+    PrintToConsole(
+        "jslimits: '{}' memory {} bytes ({} in use, high-water {}), stack {} bytes, budget {} of "
+        "{} bytes",
+        state->name, state->limits.memory_limit, state->memory_pressure.used(),
+        state->memory_pressure.high_water_mark(),
+        state->limits.max_stack_size, memory_budget.reserved(), memory_budget.total()
+    );
+    return true;
+});
+
+static bool run_plugin_command(const std::string& line, RE::TESObjectREFR* reference) {
+    const pair<const char*, decltype(onMemoryCommand)> commands[] = {
+        {BINARY_LOG_COMMAND, onBinaryLogCommand},
+        {MEMORY_COMMAND, onMemoryCommand},
+        {LIMITS_COMMAND, onLimitsCommand},
+    };
+    string_view name = string_view{line}.substr(0, line.find(' '));
+    for (auto [command, handler] : commands)
+        if (name == command) return handler(command, line.c_str(), reference);
+    return false;
+}
+
 // auto onEndJavaScriptREPL = function_pointer([](const char* command, const char* commandText,
 //                                                RE::TESObjectREFR* reference) {
 //     if (_isJavaScriptREPLRunning) {
@@ -363,11 +948,31 @@ auto onStartJavaScriptREPL = function_pointer([](const char* command, const char
 
 SKSEPlugin_Entrypoint {
     Log("Plugin loaded successfully!");
+    load_config();
+    SKSE::GetPapyrusInterface()->Register(register_papyrus_natives);
+    register_papyrus_call_pump();
+    register_papyrus_latent_pump();
+    register_papyrus_instance_sweep();
+    add_frame_pump_step(run_scheduled_gc);
+    add_frame_pump_step(sample_memory_pressure);
     SkyrimScripting::Console::Initialize();
 }
 
 SKSEPlugin_OnPostPostLoad {
     if (consoleManagerService = GetConsoleManager(); consoleManagerService) {
         consoleManagerService->add_command_handler(START_REPL_COMMAND, &onStartJavaScriptREPL);
+        consoleManagerService->add_command_handler(BINARY_LOG_COMMAND, &onBinaryLogCommand);
+        consoleManagerService->add_command_handler(MEMORY_COMMAND, &onMemoryCommand);
+        consoleManagerService->add_command_handler(LIMITS_COMMAND, &onLimitsCommand);
     }
 }
+
+SKSEPlugin_OnDataLoaded {
+    load_editor_id_index();
+    RE::UI::GetSingleton()->AddEventSink<RE::MenuOpenCloseEvent>(&game_activity_event_sink);
+}
+
+// Forms created by the previous game are gone, and their FormIDs may be reused
+SKSEPlugin_OnPreLoadGame { clear_form_cache(); }
+
+SKSEPlugin_OnNewGame { clear_form_cache(); }
@@ -0,0 +1,375 @@
+#include "psc_file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+
+#include "mapped_file.h"
+
+namespace {
+    enum class TokenKind : uint8_t { identifier, number, string, symbol, doc, newline, end };
+
+    struct Token {
+        TokenKind        kind = TokenKind::end;
+        std::string_view text;  // strings and doc comments without their delimiters
+        uint32_t         line = 0;
+    };
+
+    // Keywords are ASCII, so folding case by hand avoids a locale lookup per character
+    char fold(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+    bool iequals(std::string_view a, std::string_view b) {
+        return std::ranges::equal(a, b, [](char x, char y) { return fold(x) == fold(y); });
+    }
+
+    bool is_identifier_start(char c) { return isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+    bool is_identifier_char(char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+    bool is_number_char(char c) { return is_identifier_char(c) || c == '.'; }  // 1.5, 0xFF
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && isspace(static_cast<unsigned char>(text.front())))
+            text.remove_prefix(1);
+        while (!text.empty() && isspace(static_cast<unsigned char>(text.back())))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    // Papyrus is line-based: newlines are tokens, `\` continues a line, `;` starts a line
+    // comment, `;/ ... /;` is a block comment and `{ ... }` a doc comment
+    class Lexer {
+    public:
+        explicit Lexer(std::string_view source) : source_(source) {}
+
+        Token next() {
+            for (;;) {
+                if (pos_ >= source_.size()) return {TokenKind::end, {}, line_};
+                char c = source_[pos_];
+                if (c == ' ' || c == '\t' || c == '\r') {
+                    pos_++;
+                } else if (c == '\n') {
+                    pos_++;
+                    return {TokenKind::newline, {}, line_++};
+                } else if (c == ';') {
+                    skip_comment();
+                } else if (c == '\\' && continues_line()) {
+                    continue;
+                } else if (c == '{') {
+                    uint32_t line = line_;
+                    return {TokenKind::doc, take_until(pos_ + 1, '}'), line};
+                } else if (c == '"') {
+                    return {TokenKind::string, take_string(), line_};
+                } else if (is_identifier_start(c)) {
+                    return {TokenKind::identifier, take_while(is_identifier_char), line_};
+                } else if (isdigit(static_cast<unsigned char>(c))) {
+                    return {TokenKind::number, take_while(is_number_char), line_};
+                } else {
+                    return {TokenKind::symbol, source_.substr(pos_++, 1), line_};
+                }
+            }
+        }
+
+        // Skips the rest of the logical line, up to but not including its newline
+        void skip_line() {
+            while (pos_ < source_.size()) {
+                char c = source_[pos_];
+                if (c == '\n') return;
+                if (c == ';') skip_comment();
+                else if (c == '"') take_string();
+                else if (c == '{') take_until(pos_ + 1, '}');
+                else if (c == '\\' && continues_line()) continue;
+                else pos_++;
+            }
+        }
+
+    private:
+        void skip_comment() {
+            if (pos_ + 1 < source_.size() && source_[pos_ + 1] == '/') {
+                auto close = source_.find("/;", pos_ + 2);
+                auto stop  = close == std::string_view::npos ? source_.size() : close + 2;
+                line_ += static_cast<uint32_t>(
+                    std::count(source_.begin() + pos_, source_.begin() + stop, '\n')
+                );
+                pos_ = stop;
+                return;
+            }
+            while (pos_ < source_.size() && source_[pos_] != '\n') pos_++;
+        }
+
+        // A backslash followed only by whitespace or a comment joins the next line to this one
+        bool continues_line() {
+            size_t end = pos_ + 1;
+            while (end < source_.size() && (source_[end] == ' ' || source_[end] == '\t' ||
+                                            source_[end] == '\r'))
+                end++;
+            if (end < source_.size() && source_[end] == ';' &&
+                (end + 1 >= source_.size() || source_[end + 1] != '/')) {
+                while (end < source_.size() && source_[end] != '\n') end++;
+            }
+            if (end >= source_.size() || source_[end] != '\n') return false;
+            pos_ = end + 1;
+            line_++;
+            return true;
+        }
+
+        std::string_view take_until(size_t start, char close) {
+            auto end  = source_.find(close, start);
+            auto stop = end == std::string_view::npos ? source_.size() : end;
+            line_ += static_cast<uint32_t>(
+                std::count(source_.begin() + start, source_.begin() + stop, '\n')
+            );
+            pos_ = stop == source_.size() ? stop : stop + 1;
+            return source_.substr(start, stop - start);
+        }
+
+        std::string_view take_string() {
+            size_t start = ++pos_;
+            while (pos_ < source_.size() && source_[pos_] != '"' && source_[pos_] != '\n') {
+                if (source_[pos_] == '\\' && pos_ + 1 < source_.size()) pos_++;
+                pos_++;
+            }
+            auto text = source_.substr(start, pos_ - start);
+            if (pos_ < source_.size() && source_[pos_] == '"') pos_++;
+            return text;
+        }
+
+        template <class Predicate>
+        std::string_view take_while(Predicate predicate) {
+            size_t start = pos_;
+            while (pos_ < source_.size() && predicate(source_[pos_])) pos_++;
+            return source_.substr(start, pos_ - start);
+        }
+
+        std::string_view source_;
+        size_t           pos_  = 0;
+        uint32_t         line_ = 1;
+    };
+
+    class Parser {
+    public:
+        Parser(std::string_view source, psc::Script& script, std::string& error)
+            : lexer_(source), script_(script), error_(error) {}
+
+        void run() {
+            while (next_line()) {
+                if (keyword(0, "scriptname")) parse_header();
+                else if (keyword(0, "import")) script_.imports.emplace_back(at(1).text);
+                else if (keyword(0, "state")) begin_state(1, false);
+                else if (keyword(0, "auto") && keyword(1, "state")) begin_state(2, true);
+                else if (keyword(0, "endstate")) state_ = -1;
+                else if (keyword(0, "function") || keyword(0, "event")) parse_function(0, {});
+                else parse_typed_declaration();
+            }
+            if (script_.name.empty()) fail(1, "missing ScriptName");
+        }
+
+    private:
+        const Token& at(size_t index) const {
+            static const Token end;
+            return index < tokens_.size() ? tokens_[index] : end;
+        }
+
+        bool keyword(size_t index, std::string_view word) const {
+            return at(index).kind == TokenKind::identifier && iequals(at(index).text, word);
+        }
+
+        bool symbol(size_t index, char c) const {
+            return at(index).kind == TokenKind::symbol && at(index).text[0] == c;
+        }
+
+        void fail(uint32_t line, std::string_view message) {
+            if (error_.empty()) error_ = std::format("line {}: {}", line, message);
+        }
+
+        // Collects the next non-empty logical line. Doc comments on a line of their own belong
+        // to the declaration just before them; ones trailing a line belong to that line.
+        bool next_line() {
+            tokens_.clear();
+            line_doc_ = {};
+            for (;;) {
+                Token token = lexer_.next();
+                switch (token.kind) {
+                    case TokenKind::end:
+                        return !tokens_.empty();
+                    case TokenKind::newline:
+                        if (!tokens_.empty()) return true;
+                        break;
+                    case TokenKind::doc:
+                        if (!tokens_.empty()) line_doc_ = trim(token.text);
+                        else if (doc_target_ && doc_target_->empty())
+                            *doc_target_ = trim(token.text);
+                        break;
+                    default:
+                        if (tokens_.empty()) doc_target_ = nullptr;
+                        tokens_.push_back(token);
+                }
+            }
+        }
+
+        void document(std::string& doc) {
+            doc_target_ = &doc;
+            if (!line_doc_.empty()) doc = line_doc_;
+        }
+
+        // `Name` or `Name[]`
+        std::string type(size_t& index) const {
+            std::string name(at(index++).text);
+            if (symbol(index, '[') && symbol(index + 1, ']')) {
+                name += "[]";
+                index += 2;
+            }
+            return name;
+        }
+
+        // A literal default value (`-1`, `"text"`, `None`, ...) as written
+        std::string literal(size_t& index) const {
+            const auto& token = at(index++);
+            if (token.kind == TokenKind::string) return std::format("\"{}\"", token.text);
+            if (token.kind == TokenKind::symbol && token.text == "-")
+                return "-" + std::string(at(index++).text);
+            return std::string(token.text);
+        }
+
+        void parse_header() {
+            script_.name = at(1).text;
+            for (size_t i = 2; i < tokens_.size(); i++) {
+                if (keyword(i, "extends")) script_.parent = at(++i).text;
+                else if (keyword(i, "native")) script_.is_native = true;
+                else if (keyword(i, "hidden")) script_.is_hidden = true;
+            }
+            document(script_.doc);
+        }
+
+        void begin_state(size_t name_index, bool is_auto) {
+            auto& state   = script_.states.emplace_back();
+            state.name    = at(name_index).text;
+            state.line    = at(0).line;
+            state.is_auto = is_auto;
+            state_        = static_cast<int32_t>(script_.states.size() - 1);
+        }
+
+        void parse_typed_declaration() {
+            if (at(0).kind != TokenKind::identifier) {
+                fail(at(0).line, std::format("unexpected '{}'", at(0).text));
+                return;
+            }
+            size_t i    = 0;
+            auto   name = type(i);
+            if (keyword(i, "function")) parse_function(i, std::move(name));
+            else if (keyword(i, "property")) parse_property(i + 1, std::move(name));
+            else if (at(i).kind == TokenKind::identifier) parse_variable(i, std::move(name));
+            else fail(at(0).line, std::format("unexpected '{}'", at(i).text));
+        }
+
+        void parse_function(size_t index, std::string return_type) {
+            psc::Function function;
+            function.return_type = std::move(return_type);
+            function.is_event    = keyword(index, "event");
+            function.line        = at(0).line;
+            function.name        = at(index + 1).text;
+
+            size_t i = index + 2;
+            if (!symbol(i++, '(')) {
+                fail(function.line, std::format("expected '(' after {}", function.name));
+                return;
+            }
+            while (i < tokens_.size() && !symbol(i, ')')) {
+                psc::Parameter parameter;
+                parameter.type = type(i);
+                parameter.name = at(i++).text;
+                if (symbol(i, '=')) parameter.default_value = literal(++i);
+                function.parameters.push_back(std::move(parameter));
+                if (symbol(i, ',')) i++;
+                else if (!symbol(i, ')')) break;
+            }
+            if (!symbol(i++, ')')) fail(function.line, "expected ')' after the parameters");
+            for (; i < tokens_.size(); i++) {
+                if (keyword(i, "global")) function.is_global = true;
+                else if (keyword(i, "native")) function.is_native = true;
+            }
+
+            auto& functions = state_ < 0 ? script_.functions : script_.states[state_].functions;
+            auto& added     = functions.emplace_back(std::move(function));
+            document(added.doc);
+            added.end_line = added.line;
+            if (!added.is_native)
+                added.end_line = skip_body(added.is_event ? "endevent" : "endfunction");
+        }
+
+        void parse_property(size_t index, std::string type_name) {
+            psc::Property property;
+            property.type = std::move(type_name);
+            property.name = at(index++).text;
+            property.line = at(0).line;
+            if (symbol(index, '=')) property.default_value = literal(++index);
+            for (; index < tokens_.size(); index++) {
+                if (keyword(index, "auto")) property.is_auto = true;
+                else if (keyword(index, "autoreadonly"))
+                    property.is_auto = property.is_readonly = true;
+                else if (keyword(index, "hidden")) property.is_hidden = true;
+            }
+
+            auto& added = script_.properties.emplace_back(std::move(property));
+            document(added.doc);
+            if (!added.is_auto) skip_body("endproperty");  // full property with Get/Set bodies
+        }
+
+        void parse_variable(size_t index, std::string type_name) {
+            psc::Variable variable;
+            variable.type = std::move(type_name);
+            variable.name = at(index++).text;
+            variable.line = at(0).line;
+            if (symbol(index, '=')) variable.default_value = literal(++index);
+            for (; index < tokens_.size(); index++)
+                if (keyword(index, "conditional")) variable.is_conditional = true;
+            script_.variables.push_back(std::move(variable));
+        }
+
+        // Skips to the line starting with `end_keyword` and returns its line number. Only the
+        // first token of each body line is looked at, which keeps bodies cheap to skip.
+        uint32_t skip_body(std::string_view end_keyword) {
+            uint32_t start = at(0).line;
+            for (;;) {
+                Token token = lexer_.next();
+                if (token.kind == TokenKind::end) break;
+                if (token.kind == TokenKind::newline) continue;
+                if (token.kind == TokenKind::doc) {
+                    if (doc_target_ && doc_target_->empty()) *doc_target_ = trim(token.text);
+                    continue;
+                }
+                doc_target_ = nullptr;
+                if (token.kind == TokenKind::identifier && iequals(token.text, end_keyword)) {
+                    lexer_.skip_line();
+                    return token.line;
+                }
+                lexer_.skip_line();
+            }
+            fail(start, std::format("missing {}", end_keyword));
+            return start;
+        }
+
+        Lexer              lexer_;
+        psc::Script&       script_;
+        std::string&       error_;
+        std::vector<Token> tokens_;
+        std::string_view   line_doc_;
+        std::string*       doc_target_ = nullptr;
+        int32_t            state_      = -1;  // index into script_.states, -1 for the empty state
+    };
+}
+
+bool PscFile::load(const std::filesystem::path& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error_ = file.error();
+        return false;
+    }
+    auto data = file.data();
+    return parse({reinterpret_cast<const char*>(data.data()), data.size()});
+}
+
+bool PscFile::parse(std::string_view source) {
+    script_ = {};
+    error_.clear();
+    Parser(source, script_, error_).run();
+    return error_.empty();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Parser for Papyrus source (.psc) declarations
+//
+// Produces the script's declarations: header, imports, variables, properties, functions and
+// events, and states. Function bodies are not parsed, only their line range is kept, which is
+// all that binding generation, autocomplete and declaration lookups need. Names keep their
+// source spelling; compare them case-insensitively like Papyrus does.
+
+namespace psc {
+    struct Parameter {
+        std::string type;
+        std::string name;
+        std::string default_value;  // source text, empty when there is none
+    };
+
+    struct Function {
+        std::string            name;
+        std::string            return_type;  // empty for events and functions returning nothing
+        std::string            doc;
+        std::vector<Parameter> parameters;
+        bool                   is_event  = false;
+        bool                   is_global = false;
+        bool                   is_native = false;
+        uint32_t               line      = 0;
+        uint32_t               end_line  = 0;  // EndFunction/EndEvent, or `line` for natives
+    };
+
+    struct Property {
+        std::string type;
+        std::string name;
+        std::string default_value;
+        std::string doc;
+        bool        is_auto     = false;  // Auto or AutoReadOnly
+        bool        is_readonly = false;  // AutoReadOnly
+        bool        is_hidden   = false;
+        uint32_t    line        = 0;
+    };
+
+    struct Variable {
+        std::string type;
+        std::string name;
+        std::string default_value;
+        bool        is_conditional = false;
+        uint32_t    line           = 0;
+    };
+
+    struct State {
+        std::string           name;
+        bool                  is_auto = false;
+        std::vector<Function> functions;
+        uint32_t              line = 0;
+    };
+
+    struct Script {
+        std::string              name;
+        std::string              parent;
+        std::string              doc;
+        bool                     is_native = false;
+        bool                     is_hidden = false;
+        std::vector<std::string> imports;
+        std::vector<Variable>    variables;
+        std::vector<Property>    properties;
+        std::vector<Function>    functions;  // the empty state
+        std::vector<State>       states;
+    };
+}
+
+class PscFile {
+public:
+    // Reads and parses `path`; on failure error() says why
+    bool load(const std::filesystem::path& path);
+
+    // Parses source text; declarations after an error are still collected where possible
+    bool parse(std::string_view source);
+
+    const psc::Script& script() const { return script_; }
+    const std::string& error() const { return error_; }
+
+private:
+    psc::Script script_;
+    std::string error_;  // the first error, prefixed with its line number
+};
@@ -0,0 +1,147 @@
+#include "psc_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <thread>
+
+namespace {
+    std::string lowercase(std::string_view str) {
+        std::string result(str);
+        for (auto& c : result) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+}
+
+PscIndexStats PscIndex::update(const std::filesystem::path& directory, unsigned threads) {
+    auto          started = std::chrono::steady_clock::now();
+    PscIndexStats stats;
+    if (directory != directory_) {
+        clear();
+        directory_ = directory;
+    }
+
+    // Stat every file; only new or changed ones are queued for parsing. Map entries keep their
+    // address when the map grows, so the queue can point at them.
+    std::vector<std::string>                    present;
+    std::vector<std::pair<std::string, Entry*>> changed;
+    std::error_code                             ec;
+    for (const auto& item : std::filesystem::directory_iterator(directory, ec)) {
+        if (!item.is_regular_file(ec)) continue;
+        if (lowercase(item.path().extension().string()) != ".psc") continue;
+
+        auto  path     = item.path().string();
+        auto  modified = item.last_write_time(ec);
+        auto  size     = item.file_size(ec);
+        auto& entry    = files_[path];
+        present.push_back(path);
+        if (entry.file && entry.modified == modified && entry.size == size) continue;
+
+        entry.modified = modified;
+        entry.size     = size;
+        entry.file     = std::make_unique<PscFile>();
+        changed.emplace_back(path, &entry);
+    }
+
+    std::sort(present.begin(), present.end());
+    stats.removed = std::erase_if(files_, [&](const auto& item) {
+        return !std::binary_search(present.begin(), present.end(), item.first);
+    });
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, static_cast<unsigned>(changed.size()));
+
+    std::atomic<size_t> next = 0;
+    auto                work = [&] {
+        for (size_t i = next++; i < changed.size(); i = next++)
+            changed[i].second->ok = changed[i].second->file->load(changed[i].first);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+
+    for (const auto& [path, entry] : changed) {
+        if (!entry->ok) stats.failures.push_back({path, entry->file->error()});
+    }
+    if (!changed.empty() || stats.removed) rebuild_symbols();
+
+    auto elapsed = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started
+    );
+    stats.files        = files_.size();
+    stats.parsed       = changed.size();
+    stats.milliseconds = elapsed.count();
+    return stats;
+}
+
+void PscIndex::clear() {
+    directory_.clear();
+    files_.clear();
+    scripts_.clear();
+    symbols_.clear();
+}
+
+const psc::Script* PscIndex::find_script(std::string_view name) const {
+    auto found = scripts_.find(lowercase(name));
+    return found == scripts_.end() ? nullptr : found->second;
+}
+
+const psc::Function* PscIndex::find_function(
+    std::string_view script, std::string_view function
+) const {
+    auto name = lowercase(function);
+    // The depth limit guards against `extends` cycles in broken sources
+    const psc::Script* current = find_script(script);
+    for (int depth = 0; current && depth < 64; depth++) {
+        for (const auto& candidate : current->functions) {
+            if (lowercase(candidate.name) == name) return &candidate;
+        }
+        current = current->parent.empty() ? nullptr : find_script(current->parent);
+    }
+    return nullptr;
+}
+
+std::vector<std::string> PscIndex::complete(std::string_view prefix, size_t limit) const {
+    auto key   = lowercase(prefix);
+    auto first = std::lower_bound(
+        symbols_.begin(), symbols_.end(), key,
+        [](const auto& symbol, const std::string& value) { return symbol.first < value; }
+    );
+
+    std::vector<std::string> matches;
+    for (auto it = first; it != symbols_.end() && matches.size() < limit; ++it) {
+        if (!it->first.starts_with(key)) break;
+        matches.push_back(it->second);
+    }
+    return matches;
+}
+
+void PscIndex::rebuild_symbols() {
+    scripts_.clear();
+    symbols_.clear();
+    for (const auto& [path, entry] : files_) {
+        // Files with errors still contribute whatever declarations were parsed
+        const auto& script = entry.file->script();
+        if (script.name.empty()) continue;
+        scripts_[lowercase(script.name)] = &script;
+
+        auto add = [&](std::string display) {
+            auto key = lowercase(display);
+            symbols_.emplace_back(std::move(key), std::move(display));
+        };
+        add(script.name);
+        for (const auto& function : script.functions) add(script.name + "." + function.name);
+        for (const auto& property : script.properties) add(script.name + "." + property.name);
+        for (const auto& state : script.states) {
+            for (const auto& function : state.functions) add(script.name + "." + function.name);
+        }
+    }
+
+    std::sort(symbols_.begin(), symbols_.end());
+    auto duplicates = std::unique(symbols_.begin(), symbols_.end(), [](auto& a, auto& b) {
+        return a.first == b.first;
+    });
+    symbols_.erase(duplicates, symbols_.end());
+}
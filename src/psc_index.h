@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "psc_file.h"
+
+struct PscIndexFailure {
+    std::filesystem::path path;
+    std::string           error;
+};
+
+struct PscIndexStats {
+    size_t                       files        = 0;  // indexed after the update
+    size_t                       parsed       = 0;  // new or changed files parsed by this update
+    size_t                       removed      = 0;
+    double                       milliseconds = 0;
+    std::vector<PscIndexFailure> failures;  // files that did not parse, from this update
+};
+
+// Symbol index over a folder of Papyrus sources
+//
+// update() only re-parses files whose modification time or size changed since the previous
+// update of the same folder, spread over all cores. Lookups are case-insensitive.
+class PscIndex {
+public:
+    PscIndexStats update(const std::filesystem::path& directory, unsigned threads = 0);
+    void          clear();
+
+    const psc::Script* find_script(std::string_view name) const;
+
+    // Searches the script and then its parents, like a Papyrus call would
+    const psc::Function* find_function(std::string_view script, std::string_view function) const;
+
+    // Script names and `Script.Member` names starting with `prefix`, in sorted order
+    std::vector<std::string> complete(std::string_view prefix, size_t limit = 50) const;
+
+    size_t size() const { return scripts_.size(); }
+
+private:
+    struct Entry {
+        std::filesystem::file_time_type modified;
+        uintmax_t                       size = 0;
+        std::unique_ptr<PscFile>        file;
+        bool                            ok = false;
+    };
+
+    void rebuild_symbols();
+
+    std::filesystem::path                               directory_;
+    std::unordered_map<std::string, Entry>              files_;    // by path
+    std::unordered_map<std::string, const psc::Script*> scripts_;  // by lowercased name
+    std::vector<std::pair<std::string, std::string>>    symbols_;  // (lowercased, display)
+};
@@ -0,0 +1,163 @@
+#include "psc_js.h"
+
+#include "context_state.h"
+#include "js_atoms.h"
+#include "js_marshal.h"
+
+namespace {
+    JSValue parameters_to_js(JSContext* ctx, const std::vector<psc::Parameter>& parameters) {
+        JSValue array = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < parameters.size(); i++) {
+            JSValue entry = JS_NewObject(ctx);
+            js_set_property(ctx, entry, JSAtomName::type, to_js(ctx, parameters[i].type));
+            js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, parameters[i].name));
+            if (!parameters[i].default_value.empty()) {
+                JS_SetPropertyStr(
+                    ctx, entry, "defaultValue", to_js(ctx, parameters[i].default_value)
+                );
+            }
+            JS_SetPropertyUint32(ctx, array, i, entry);
+        }
+        return array;
+    }
+
+    JSValue functions_to_js(JSContext* ctx, const std::vector<psc::Function>& functions) {
+        JSValue array = JS_NewArray(ctx);
+        for (uint32_t i = 0; i < functions.size(); i++) {
+            const auto& function = functions[i];
+            JSValue     entry    = JS_NewObject(ctx);
+            js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, function.name));
+            JS_SetPropertyStr(ctx, entry, "returnType", to_js(ctx, function.return_type));
+            JS_SetPropertyStr(
+                ctx, entry, "parameters", parameters_to_js(ctx, function.parameters)
+            );
+            JS_SetPropertyStr(ctx, entry, "event", to_js(ctx, function.is_event));
+            JS_SetPropertyStr(ctx, entry, "global", to_js(ctx, function.is_global));
+            JS_SetPropertyStr(ctx, entry, "native", to_js(ctx, function.is_native));
+            js_set_property(ctx, entry, JSAtomName::line, to_js(ctx, function.line));
+            JS_SetPropertyStr(ctx, entry, "endLine", to_js(ctx, function.end_line));
+            if (!function.doc.empty())
+                JS_SetPropertyStr(ctx, entry, "doc", to_js(ctx, function.doc));
+            JS_SetPropertyUint32(ctx, array, i, entry);
+        }
+        return array;
+    }
+}
+
+JSValue psc_script_to_js(JSContext* ctx, const psc::Script& script) {
+    JSValue obj = JS_NewObject(ctx);
+    js_set_property(ctx, obj, JSAtomName::name, to_js(ctx, script.name));
+    JS_SetPropertyStr(ctx, obj, "parent", to_js(ctx, script.parent));
+    JS_SetPropertyStr(ctx, obj, "native", to_js(ctx, script.is_native));
+    JS_SetPropertyStr(ctx, obj, "hidden", to_js(ctx, script.is_hidden));
+    if (!script.doc.empty()) JS_SetPropertyStr(ctx, obj, "doc", to_js(ctx, script.doc));
+    JS_SetPropertyStr(ctx, obj, "imports", to_js(ctx, script.imports));
+
+    JSValue variables = JS_NewArray(ctx);
+    for (uint32_t i = 0; i < script.variables.size(); i++) {
+        const auto& variable = script.variables[i];
+        JSValue     entry    = JS_NewObject(ctx);
+        js_set_property(ctx, entry, JSAtomName::type, to_js(ctx, variable.type));
+        js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, variable.name));
+        if (!variable.default_value.empty())
+            JS_SetPropertyStr(ctx, entry, "defaultValue", to_js(ctx, variable.default_value));
+        js_set_property(ctx, entry, JSAtomName::line, to_js(ctx, variable.line));
+        JS_SetPropertyUint32(ctx, variables, i, entry);
+    }
+    JS_SetPropertyStr(ctx, obj, "variables", variables);
+
+    JSValue properties = JS_NewArray(ctx);
+    for (uint32_t i = 0; i < script.properties.size(); i++) {
+        const auto& property = script.properties[i];
+        JSValue     entry    = JS_NewObject(ctx);
+        js_set_property(ctx, entry, JSAtomName::type, to_js(ctx, property.type));
+        js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, property.name));
+        if (!property.default_value.empty())
+            JS_SetPropertyStr(ctx, entry, "defaultValue", to_js(ctx, property.default_value));
+        JS_SetPropertyStr(ctx, entry, "auto", to_js(ctx, property.is_auto));
+        JS_SetPropertyStr(ctx, entry, "readOnly", to_js(ctx, property.is_readonly));
+        JS_SetPropertyStr(ctx, entry, "hidden", to_js(ctx, property.is_hidden));
+        if (!property.doc.empty()) JS_SetPropertyStr(ctx, entry, "doc", to_js(ctx, property.doc));
+        js_set_property(ctx, entry, JSAtomName::line, to_js(ctx, property.line));
+        JS_SetPropertyUint32(ctx, properties, i, entry);
+    }
+    JS_SetPropertyStr(ctx, obj, "properties", properties);
+
+    JS_SetPropertyStr(ctx, obj, "functions", functions_to_js(ctx, script.functions));
+
+    JSValue states = JS_NewArray(ctx);
+    for (uint32_t i = 0; i < script.states.size(); i++) {
+        const auto& state = script.states[i];
+        JSValue     entry = JS_NewObject(ctx);
+        js_set_property(ctx, entry, JSAtomName::name, to_js(ctx, state.name));
+        JS_SetPropertyStr(ctx, entry, "auto", to_js(ctx, state.is_auto));
+        JS_SetPropertyStr(ctx, entry, "functions", functions_to_js(ctx, state.functions));
+        js_set_property(ctx, entry, JSAtomName::line, to_js(ctx, state.line));
+        JS_SetPropertyUint32(ctx, states, i, entry);
+    }
+    JS_SetPropertyStr(ctx, obj, "states", states);
+    return obj;
+}
+
+JSValue js_psc_parse(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    std::string path;
+    if (argc < 1 || !from_js(ctx, argv[0], path))
+        return JS_ThrowTypeError(ctx, "parse expects a file path");
+
+    PscFile file;
+    if (!file.load(path))
+        return JS_ThrowSyntaxError(ctx, "%s: %s", path.c_str(), file.error().c_str());
+    return psc_script_to_js(ctx, file.script());
+}
+
+JSValue js_psc_index(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    std::string path;
+    if (argc < 1 || !from_js(ctx, argv[0], path))
+        return JS_ThrowTypeError(ctx, "index expects a folder path");
+
+    uint32_t threads = 0;
+    if (argc > 1 && JS_IsObject(argv[1])) {
+        JSValue value = JS_GetPropertyStr(ctx, argv[1], "threads");
+        if (!JS_IsUndefined(value)) from_js(ctx, value, threads);
+        JS_FreeValue(ctx, value);
+    }
+
+    auto& index = get_context_state(ctx)->source_index;
+    auto  stats = index.update(path, threads);
+
+    JSValue failures = JS_NewArray(ctx);
+    for (uint32_t i = 0; i < stats.failures.size(); i++) {
+        JSValue failure = JS_NewObject(ctx);
+        JS_SetPropertyStr(ctx, failure, "path", to_js(ctx, stats.failures[i].path.string()));
+        JS_SetPropertyStr(ctx, failure, "error", to_js(ctx, stats.failures[i].error));
+        JS_SetPropertyUint32(ctx, failures, i, failure);
+    }
+
+    JSValue result = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, result, "files", to_js(ctx, uint32_t(stats.files)));
+    JS_SetPropertyStr(ctx, result, "scripts", to_js(ctx, uint32_t(index.size())));
+    JS_SetPropertyStr(ctx, result, "parsed", to_js(ctx, uint32_t(stats.parsed)));
+    JS_SetPropertyStr(ctx, result, "removed", to_js(ctx, uint32_t(stats.removed)));
+    JS_SetPropertyStr(ctx, result, "milliseconds", to_js(ctx, stats.milliseconds));
+    JS_SetPropertyStr(ctx, result, "failures", failures);
+    return result;
+}
+
+JSValue js_psc_find(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    std::string name;
+    if (argc < 1 || !from_js(ctx, argv[0], name))
+        return JS_ThrowTypeError(ctx, "find expects a script name");
+
+    const auto* script = get_context_state(ctx)->source_index.find_script(name);
+    return script ? psc_script_to_js(ctx, *script) : JS_NULL;
+}
+
+JSValue js_psc_complete(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    std::string prefix;
+    if (argc < 1 || !from_js(ctx, argv[0], prefix))
+        return JS_ThrowTypeError(ctx, "complete expects a prefix");
+
+    uint32_t limit = 50;
+    if (argc > 1 && !JS_IsUndefined(argv[1])) from_js(ctx, argv[1], limit);
+    return to_js(ctx, get_context_state(ctx)->source_index.complete(prefix, limit));
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "psc_file.h"
+#include "quickjs.h"
+
+// Plain-object view of a parsed .psc script
+JSValue psc_script_to_js(JSContext* ctx, const psc::Script& script);
+
+// Psc.parse(path) parses one .psc file
+JSValue js_psc_parse(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+
+// Psc.index(folder, { threads }) indexes a source folder for this context, re-parsing only
+// changed files on later calls, and returns the update's totals and failures
+JSValue js_psc_index(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+
+// Psc.find(name) returns an indexed script, or null
+JSValue js_psc_find(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
+
+// Psc.complete(prefix, limit) returns indexed `Script` and `Script.Member` names
+JSValue js_psc_complete(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv);
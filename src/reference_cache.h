@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "quickjs.h"
+
+// Weak map from form IDs to the live JS wrapper of each game reference, for one runtime
+//
+// Entries do not own the wrapper: its finalizer removes the entry, so a form ID maps to the same
+// object for exactly as long as JS code can still reach it.
+class ReferenceCache {
+public:
+    // A new reference to the live wrapper for `form_id`, or JS_UNDEFINED
+    JSValue find(JSContext* ctx, uint32_t form_id) const;
+    void    set(uint32_t form_id, JSValueConst wrapper);
+
+    // Called from the finalizer; leaves the entry alone when it maps to a newer wrapper
+    void erase(uint32_t form_id, JSValueConst wrapper);
+
+    size_t size() const { return wrappers_.size(); }
+
+private:
+    std::unordered_map<uint32_t, JSValue> wrappers_;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "gc_scheduler.h"
+#include "js_allocator.h"
+#include "js_atoms.h"
+#include "quickjs.h"
+#include "reference_cache.h"
+
+// Native state owned by a single JSRuntime, stored as the runtime opaque
+//
+// Created before the runtime (its allocator backs JS_NewRuntime2) and destroyed after
+// JS_FreeRuntime.
+struct RuntimeState {
+    PooledJSAllocator allocator;
+    GcScheduler       gc_scheduler;
+    JSAtomTable       atoms;       // interned with the first context, released before the runtime
+    ReferenceCache    references;  // emptied by the wrappers' finalizers
+};
+
+inline RuntimeState* get_runtime_state(JSRuntime* rt) {
+    return static_cast<RuntimeState*>(JS_GetRuntimeOpaque(rt));
+}
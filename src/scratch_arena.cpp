@@ -0,0 +1,69 @@
+#include "scratch_arena.h"
+
+#include <algorithm>
+
+void ScratchArena::reset() {
+    for (const auto& block : heap_blocks_) {
+        std::pmr::new_delete_resource()->deallocate(block.data, block.size, block.alignment);
+    }
+    heap_blocks_.clear();
+
+    size_t kept = 0;
+    size_t keep = 0;
+    while (keep < chunks_.size() && kept + chunks_[keep].size <= retained_bytes_)
+        kept += chunks_[keep++].size;
+    chunks_.resize(keep);
+
+    current_    = 0;
+    offset_     = 0;
+    arena_used_ = 0;
+}
+
+size_t ScratchArena::bytes_used() const {
+    size_t used = offset_;
+    for (size_t i = 0; i < current_ && i < chunks_.size(); i++) used += chunks_[i].size;
+    return used;
+}
+
+size_t ScratchArena::bytes_reserved() const {
+    size_t reserved = 0;
+    for (const auto& chunk : chunks_) reserved += chunk.size;
+    return reserved;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    if (arena_used_ + bytes > byte_limit_) {
+        void* data = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        heap_blocks_.push_back({data, bytes, alignment});
+        return data;
+    }
+    arena_used_ += bytes;
+
+    while (current_ < chunks_.size()) {
+        auto&  chunk   = chunks_[current_];
+        auto   base    = reinterpret_cast<uintptr_t>(chunk.data.get());
+        size_t aligned = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+        if (aligned + bytes <= chunk.size) {
+            offset_ = aligned + bytes;
+            return chunk.data.get() + aligned;
+        }
+        current_++;
+        offset_ = 0;
+    }
+
+    // Out of retained chunks: add one big enough for this request
+    size_t size = std::max(chunk_size_, bytes + alignment);
+    chunks_.push_back({std::make_unique<std::byte[]>(size), size});
+    current_ = chunks_.size() - 1;
+    offset_  = 0;
+    arena_used_ -= bytes;  // counted again by the retry
+    return do_allocate(bytes, alignment);
+}
+
+void ScratchArena::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    // Chunk memory waits for reset(); only heap blocks are freed one by one
+    auto found = std::ranges::find(heap_blocks_, ptr, &HeapBlock::data);
+    if (found == heap_blocks_.end()) return;
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    heap_blocks_.erase(found);
+}
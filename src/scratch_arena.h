@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for native temporaries that only live for one JS evaluation
+//
+// Deallocation is a no-op; everything is reclaimed at once by reset(), which rewinds to the
+// first chunk and keeps up to `retained_bytes` of chunks so later evaluations don't go back to
+// the heap, so one large evaluation does not pin its high-water mark. Past `byte_limit` in one
+// evaluation, allocations come from the heap and are freed normally. Use through std::pmr
+// containers (std::pmr::string, std::pmr::vector) or allocate() directly.
+class ScratchArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t default_chunk_size     = 64 * 1024;
+    static constexpr size_t default_byte_limit     = 4 * 1024 * 1024;
+    static constexpr size_t default_retained_bytes = 256 * 1024;
+
+    ScratchArena() = default;
+    explicit ScratchArena(
+        size_t chunk_size, size_t byte_limit = default_byte_limit,
+        size_t retained_bytes = default_retained_bytes
+    )
+        : chunk_size_(chunk_size), byte_limit_(byte_limit), retained_bytes_(retained_bytes) {}
+    ~ScratchArena() override { reset(); }
+
+    ScratchArena(const ScratchArena&)            = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    void reset();
+
+    size_t bytes_used() const;
+    size_t bytes_reserved() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::byte[]> data;
+        size_t                       size;
+    };
+
+    // An allocation past byte_limit_, taken from the heap
+    struct HeapBlock {
+        void*  data;
+        size_t size;
+        size_t alignment;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void  do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    size_t                 chunk_size_     = default_chunk_size;
+    size_t                 byte_limit_     = default_byte_limit;
+    size_t                 retained_bytes_ = default_retained_bytes;
+    std::vector<Chunk>     chunks_;
+    std::vector<HeapBlock> heap_blocks_;
+    size_t                 current_    = 0;  // index of the chunk being bumped
+    size_t                 offset_     = 0;  // bump offset within chunks_[current_]
+    size_t                 arena_used_ = 0;  // bytes handed out from chunks since reset()
+};
+
+// Resets the arena, trimming it to its retained size, when the outermost scope ends, so nested
+// evaluations (JS calling native code that evaluates more JS) keep their callers' temporaries
+// alive
+class ScratchScope {
+public:
+    explicit ScratchScope(ScratchArena& arena, int& depth) : arena_(arena), depth_(depth) {
+        depth_++;
+    }
+    ~ScratchScope() {
+        if (--depth_ == 0) arena_.reset();
+    }
+
+    ScratchScope(const ScratchScope&)            = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+private:
+    ScratchArena& arena_;
+    int&          depth_;
+};
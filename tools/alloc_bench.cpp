@@ -0,0 +1,221 @@
+// Benchmarks PooledJSAllocator against the system heap on QuickJS-shaped allocation patterns
+//
+// Usage: alloc-bench [--ops N] [--trace FILE]
+//
+// Both allocators are driven through the JSMallocFunctions table that JS_NewRuntime2 receives,
+// so each call costs what it costs inside the runtime. The built-in patterns mimic what scripts
+// make QuickJS do: short-lived small objects, strings of mixed sizes, arrays grown by realloc,
+// and a heap that is only released when its context is torn down (the pooled allocator drops
+// its slabs instead of freeing each block).
+//
+// A trace file replays a recorded pattern instead, one operation per line, slots being small
+// integers naming live blocks:
+//   m <slot> <size>   allocate
+//   r <slot> <size>   reallocate
+//   f <slot>          free
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "js_allocator.h"
+
+namespace {
+    enum class OpKind : uint8_t { Malloc, Realloc, Free };
+
+    struct Op {
+        OpKind   kind;
+        uint32_t slot;
+        uint32_t size;
+    };
+
+    struct Pattern {
+        explicit Pattern(const char* name) : name(name) {}
+
+        const char*     name;
+        std::vector<Op> ops;
+        size_t          slots = 0;
+    };
+
+    // QuickJS objects, shapes and closures: mostly 16-128 bytes, freed soon after
+    Pattern object_churn(size_t op_count, std::mt19937& random) {
+        Pattern                                 pattern("object churn");
+        std::uniform_int_distribution<uint32_t> size(16, 128);
+        constexpr uint32_t                      window = 4096;
+        std::vector<bool>                       live(window);
+        for (size_t i = 0; i < op_count; i++) {
+            auto slot = static_cast<uint32_t>(random() % window);
+            pattern.ops.push_back({live[slot] ? OpKind::Free : OpKind::Malloc, slot, size(random)});
+            live[slot] = !live[slot];
+        }
+        pattern.slots = window;
+        return pattern;
+    }
+
+    // Strings: a few bytes to a few hundred, with the odd long one
+    Pattern strings(size_t op_count, std::mt19937& random) {
+        Pattern                                 pattern("strings");
+        std::geometric_distribution<uint32_t>   length(0.02);
+        constexpr uint32_t                      window = 16384;
+        std::vector<bool>                       live(window);
+        for (size_t i = 0; i < op_count; i++) {
+            auto slot = static_cast<uint32_t>(random() % window);
+            auto size = 17 + length(random) + (random() % 200 == 0 ? 4096 : 0);
+            pattern.ops.push_back({live[slot] ? OpKind::Free : OpKind::Malloc, slot, size});
+            live[slot] = !live[slot];
+        }
+        pattern.slots = window;
+        return pattern;
+    }
+
+    // Arrays pushed one element at a time: QuickJS grows their storage by about 1.5x
+    Pattern growing_arrays(size_t op_count, std::mt19937& random) {
+        Pattern                                 pattern("growing arrays");
+        std::uniform_int_distribution<uint32_t> final_length(4, 2048);
+        constexpr uint32_t                      window = 256;
+        for (uint32_t slot = 0; pattern.ops.size() < op_count; slot = (slot + 1) % window) {
+            uint32_t capacity = 4;
+            uint32_t target   = final_length(random);
+            pattern.ops.push_back({OpKind::Malloc, slot, capacity * 16});
+            while (capacity < target) {
+                capacity += capacity / 2;
+                pattern.ops.push_back({OpKind::Realloc, slot, capacity * 16});
+            }
+            pattern.ops.push_back({OpKind::Free, slot, 0});
+        }
+        pattern.slots = window;
+        return pattern;
+    }
+
+    // A context's heap built up and never freed block by block; see replay()
+    Pattern retained_heap(size_t op_count, std::mt19937& random) {
+        Pattern                                 pattern("retained heap");
+        std::uniform_int_distribution<uint32_t> size(16, 256);
+        for (size_t i = 0; i < op_count; i++)
+            pattern.ops.push_back({OpKind::Malloc, static_cast<uint32_t>(i), size(random)});
+        pattern.slots = op_count;
+        return pattern;
+    }
+
+    bool load_trace(const char* path, Pattern& pattern) {
+        std::ifstream in(path);
+        if (!in) return false;
+        std::string line;
+        while (std::getline(in, line)) {
+            char     kind = 0;
+            uint32_t slot = 0, size = 0;
+            if (sscanf(line.c_str(), " %c %u %u", &kind, &slot, &size) < 2) continue;
+            if (kind == 'm') pattern.ops.push_back({OpKind::Malloc, slot, size});
+            else if (kind == 'r') pattern.ops.push_back({OpKind::Realloc, slot, size});
+            else if (kind == 'f') pattern.ops.push_back({OpKind::Free, slot, 0});
+            else continue;
+            pattern.slots = std::max<size_t>(pattern.slots, slot + 1);
+        }
+        return true;
+    }
+
+    // Replays `pattern` through `functions` and returns the elapsed nanoseconds. Blocks still
+    // live at the end are freed one by one, except when `drop_heap` releases them all at once
+    template <class DropHeap>
+    double replay(
+        const Pattern& pattern, const JSMallocFunctions& functions, void* opaque,
+        DropHeap drop_heap
+    ) {
+        std::vector<void*> blocks(pattern.slots);
+        auto               started = std::chrono::steady_clock::now();
+        for (const auto& op : pattern.ops) {
+            void*& block = blocks[op.slot];
+            switch (op.kind) {
+                case OpKind::Malloc:
+                    if (block) functions.js_free(opaque, block);
+                    block = functions.js_malloc(opaque, op.size);
+                    break;
+                case OpKind::Realloc:
+                    block = functions.js_realloc(opaque, block, op.size);
+                    break;
+                case OpKind::Free:
+                    functions.js_free(opaque, block);
+                    block = nullptr;
+                    break;
+            }
+            if (block) static_cast<uint8_t*>(block)[0] = 1;  // touch it, as the runtime would
+        }
+        if (!drop_heap()) {
+            for (void* block : blocks) functions.js_free(opaque, block);
+        }
+        return std::chrono::duration<double, std::nano>(
+                   std::chrono::steady_clock::now() - started
+        )
+            .count();
+    }
+
+    const JSMallocFunctions system_heap = {
+        [](void*, size_t count, size_t size) { return calloc(count, size); },
+        [](void*, size_t size) { return malloc(size); },
+        [](void*, void* ptr) { free(ptr); },
+        [](void*, void* ptr, size_t size) { return realloc(ptr, size); },
+        nullptr,
+    };
+
+    void run(const Pattern& pattern) {
+        double system = replay(pattern, system_heap, nullptr, [] { return false; });
+
+        auto   pooled_allocator = std::make_unique<PooledJSAllocator>();
+        double pooled           = replay(
+            pattern, pooled_allocator->malloc_functions(), pooled_allocator.get(),
+            [&] {
+                pooled_allocator.reset();  // as JS_FreeRuntime's owner does
+                return true;
+            }
+        );
+
+        double ops = static_cast<double>(pattern.ops.size());
+        printf(
+            "  %-16s %9zu ops  system %6.1f ns/op  pooled %6.1f ns/op  (%.2fx)\n",
+            pattern.name, pattern.ops.size(), system / ops, pooled / ops, system / pooled
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t      op_count = 2000000;
+    const char* trace    = nullptr;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 < argc && strcmp(argv[i], "--ops") == 0) {
+            op_count = strtoull(argv[i + 1], nullptr, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--trace") == 0) {
+            trace = argv[i + 1];
+        } else {
+            fprintf(stderr, "usage: %s [--ops N] [--trace FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (op_count == 0) return 2;
+
+    std::vector<Pattern> patterns;
+    if (trace) {
+        Pattern pattern(trace);
+        if (!load_trace(trace, pattern)) {
+            fprintf(stderr, "cannot read %s\n", trace);
+            return 1;
+        }
+        patterns.push_back(std::move(pattern));
+    } else {
+        std::mt19937 random(1234);
+        patterns.push_back(object_churn(op_count, random));
+        patterns.push_back(strings(op_count, random));
+        patterns.push_back(growing_arrays(op_count, random));
+        patterns.push_back(retained_heap(op_count, random));
+    }
+
+    for (const auto& pattern : patterns) run(pattern);
+    return 0;
+}
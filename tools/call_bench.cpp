@@ -0,0 +1,170 @@
+// Measures Papyrus.call() dispatch, batched per frame or immediate, against a stand-in VM
+//
+// Usage: call-bench [--calls N] [--per-frame N] [--vm-threads N]
+//
+// The stand-in VM mirrors what the plugin relies on: every dispatch takes the VM's lock, copies
+// the call into a new stack and wakes a VM thread, which resolves the function by name, runs it
+// and hands the result back through PapyrusCallQueue::complete from its own thread. The script
+// side issues calls with the same PapyrusCallQueue the plugin uses; immediate mode dispatches
+// each call as it is made, batched mode queues it and the end-of-frame pump dispatches the
+// frame's calls together. Both modes settle results in the pump. Reported are the time the
+// script spends per call, the pump's time per call, and how long until every result is back.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "papyrus_call_queue.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    class StandInVM {
+    public:
+        explicit StandInVM(PapyrusCallQueue& results, int threads) : results_(results) {
+            functions_["Debug.Notification"] = [](const auto&) { return PapyrusValue{}; };
+            functions_["Utility.RandomInt"]  = [](const auto& args) {
+                return PapyrusValue{args.empty() ? 0 : std::get<int32_t>(args[0]) + 1};
+            };
+            for (int i = 0; i < threads; i++) threads_.emplace_back([this] { run(); });
+        }
+
+        ~StandInVM() {
+            {
+                std::lock_guard lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (auto& thread : threads_) thread.join();
+        }
+
+        // DispatchStaticCall: the call is copied into a stack owned by the VM
+        bool dispatch(const PapyrusCall& call) {
+            {
+                std::lock_guard lock(mutex_);
+                stacks_.push_back(call);
+            }
+            wake_.notify_one();
+            return true;
+        }
+
+    private:
+        using Function = PapyrusValue (*)(const std::vector<PapyrusValue>&);
+
+        void run() {
+            std::unique_lock lock(mutex_);
+            for (;;) {
+                wake_.wait(lock, [this] { return stopping_ || !stacks_.empty(); });
+                if (stacks_.empty()) return;
+                PapyrusCall stack = std::move(stacks_.front());
+                stacks_.pop_front();
+                lock.unlock();
+
+                PapyrusCallResult result{.id = stack.id};
+                auto found = functions_.find(stack.script + "." + stack.function);
+                if (found != functions_.end()) {
+                    result.ok    = true;
+                    result.value = found->second(stack.args);
+                } else {
+                    result.error = "no such function";
+                }
+                results_.complete(std::move(result));
+                lock.lock();
+            }
+        }
+
+        PapyrusCallQueue&                         results_;
+        std::unordered_map<std::string, Function> functions_;
+        std::mutex                                mutex_;
+        std::condition_variable                   wake_;
+        std::deque<PapyrusCall>                   stacks_;
+        bool                                      stopping_ = false;
+        std::vector<std::thread>                  threads_;
+    };
+
+    PapyrusCall make_call(size_t n) {
+        if (n % 2 == 0)
+            return {.script = "Debug", .function = "Notification", .args = {std::string("hi")}};
+        return {.script = "Utility", .function = "RandomInt", .args = {static_cast<int32_t>(n)}};
+    }
+
+    void run(const char* label, bool batched, size_t calls, size_t per_frame, int vm_threads) {
+        PapyrusCallQueue queue;
+        StandInVM        vm(queue, vm_threads);
+
+        double script_ns = 0, pump_ns = 0;
+        size_t settled = 0, frames = 0;
+        auto   pump    = [&] {
+            auto started = Clock::now();
+            if (batched) {
+                for (auto& call : queue.take_pending()) vm.dispatch(call);
+            }
+            settled += queue.take_completed().size();
+            pump_ns += std::chrono::duration<double, std::nano>(Clock::now() - started).count();
+            frames++;
+        };
+
+        auto started = Clock::now();
+        for (size_t n = 0; n < calls;) {
+            auto frame_started = Clock::now();
+            for (size_t i = 0; i < per_frame && n < calls; i++, n++) {
+                PapyrusCall call = make_call(n);
+                if (batched) {
+                    queue.enqueue(std::move(call));
+                } else {
+                    call.id = queue.next_id();
+                    vm.dispatch(call);
+                }
+            }
+            script_ns +=
+                std::chrono::duration<double, std::nano>(Clock::now() - frame_started).count();
+            pump();
+        }
+        while (settled < calls) {
+            std::this_thread::yield();
+            pump();
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - started);
+
+        printf(
+            "  %-10s script %6.1f ns/call  pump %6.1f ns/call  all results in %7.1f ms "
+            "(%zu pumps)\n",
+            label, script_ns / calls, pump_ns / calls, elapsed.count(), frames
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t calls      = 500000;
+    size_t per_frame  = 100;
+    int    vm_threads = 2;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 < argc && strcmp(argv[i], "--calls") == 0) {
+            calls = strtoull(argv[i + 1], nullptr, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--per-frame") == 0) {
+            per_frame = strtoull(argv[i + 1], nullptr, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--vm-threads") == 0) {
+            vm_threads = atoi(argv[i + 1]);
+        } else {
+            fprintf(
+                stderr, "usage: %s [--calls N] [--per-frame N] [--vm-threads N]\n", argv[0]
+            );
+            return 2;
+        }
+    }
+    if (calls == 0 || per_frame == 0 || vm_threads < 1) return 2;
+
+    printf("%zu calls, %zu per frame, %d VM threads\n", calls, per_frame, vm_threads);
+    run("immediate", false, calls, per_frame, vm_threads);
+    run("batched", true, calls, per_frame, vm_threads);
+    return 0;
+}
@@ -0,0 +1,166 @@
+// Benchmarks FormCache against a stand-in form database shaped like the game's form tables
+//
+// Usage: form-bench [--forms N] [--lookups N]
+//
+// The stand-in keeps its forms in hash maps behind a reader-writer lock, like the game's global
+// form and editor ID tables, and interns each editor ID it is asked for into a locked string
+// pool first, as the game does when it builds the BSFixedString key. Lookups are skewed (a few
+// forms are asked for over and over, as scripts do) and 1% ask for forms that do not exist.
+// The editor ID index is built from the same forms in the temp directory and timed as well.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "editor_id_index.h"
+#include "form_cache.h"
+
+namespace {
+    struct StandInForm {
+        uint32_t    form_id;
+        std::string editor_id;
+    };
+
+    std::vector<StandInForm>                   forms;
+    std::unordered_map<uint32_t, StandInForm*> forms_by_id;
+    std::unordered_map<std::string, uint32_t>  forms_by_editor_id;  // lowercased
+    std::shared_mutex                          forms_lock;
+    std::unordered_map<std::string, uint32_t>  string_pool;  // lowercased -> reference count
+    std::mutex                                 string_pool_lock;
+
+    StandInForm* find_by_id(uint32_t form_id) {
+        std::shared_lock lock(forms_lock);
+        auto             found = forms_by_id.find(form_id);
+        return found == forms_by_id.end() ? nullptr : found->second;
+    }
+
+    uint32_t find_by_editor_id(std::string_view editor_id) {
+        std::string key(editor_id);
+        for (auto& c : key) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        {
+            std::lock_guard pool_lock(string_pool_lock);
+            string_pool[key]++;
+        }
+        std::shared_lock lock(forms_lock);
+        auto             found = forms_by_editor_id.find(key);
+        return found == forms_by_editor_id.end() ? 0 : found->second;
+    }
+
+    uint32_t form_id_at(size_t index) { return 0x01000800 + static_cast<uint32_t>(index); }
+
+    std::string editor_id_at(size_t index) {
+        char name[32];
+        snprintf(name, sizeof(name), "BenchForm%07zu", index);
+        return name;
+    }
+
+    // Times `lookup` over every query and prints the cost per lookup
+    template <class Query, class Lookup>
+    void run(const char* label, const std::vector<Query>& queries, Lookup lookup) {
+        auto   started = std::chrono::steady_clock::now();
+        size_t found   = 0;
+        for (const auto& query : queries) found += lookup(query) ? 1 : 0;
+        auto elapsed = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - started
+        );
+        printf(
+            "  %-22s %7.1f ns/lookup  (%zu found)\n", label, elapsed.count() / queries.size(),
+            found
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t form_count   = 500000;
+    size_t lookup_count = 5000000;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 < argc && strcmp(argv[i], "--forms") == 0) {
+            form_count = strtoull(argv[i + 1], nullptr, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--lookups") == 0) {
+            lookup_count = strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--forms N] [--lookups N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (form_count == 0 || lookup_count == 0) return 2;
+
+    forms.reserve(form_count);
+    for (size_t i = 0; i < form_count; i++) forms.push_back({form_id_at(i), editor_id_at(i)});
+    for (auto& form : forms) {
+        forms_by_id.emplace(form.form_id, &form);
+        std::string key = form.editor_id;
+        for (auto& c : key) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        forms_by_editor_id.emplace(std::move(key), form.form_id);
+    }
+
+    // u^4 puts most lookups on a small set of forms
+    std::mt19937                           random(1234);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<uint32_t>                  id_queries;
+    std::vector<std::string>               editor_id_queries;
+    id_queries.reserve(lookup_count);
+    editor_id_queries.reserve(lookup_count);
+    for (size_t i = 0; i < lookup_count; i++) {
+        auto index = static_cast<size_t>(std::pow(uniform(random), 4) * form_count);
+        if (i % 100 == 0) index += form_count;  // no such form
+        id_queries.push_back(form_id_at(index));
+        editor_id_queries.push_back(editor_id_at(index));
+    }
+
+    printf("%zu forms, %zu lookups\n", form_count, lookup_count);
+    FormCache<StandInForm> cache(find_by_id, find_by_editor_id);
+    run("FormID, direct", id_queries, find_by_id);
+    run("FormID, cached", id_queries, [&](uint32_t id) { return cache.get(id); });
+    run("editor ID, direct", editor_id_queries, [](const std::string& editor_id) {
+        return find_by_id(find_by_editor_id(editor_id));
+    });
+    run("editor ID, cached", editor_id_queries, [&](const std::string& editor_id) {
+        return cache.by_editor_id(editor_id);
+    });
+
+    std::vector<EditorIdEntry> entries;
+    entries.reserve(forms.size());
+    for (const auto& form : forms) entries.push_back({form.editor_id, form.form_id});
+    auto          index_path = std::filesystem::temp_directory_path() / "form-bench.editorids";
+    EditorIdIndex index;
+    auto          started = std::chrono::steady_clock::now();
+    if (!index.build(index_path, 0, std::move(entries))) {
+        fprintf(
+            stderr, "cannot build %s: %s\n", index_path.string().c_str(), index.error().c_str()
+        );
+        return 1;
+    }
+    auto built = std::chrono::steady_clock::now();
+    index.open(index_path);  // as a later launch with the same load order would
+    auto opened = std::chrono::steady_clock::now();
+    run("editor ID, index", editor_id_queries, [&](const std::string& editor_id) {
+        return find_by_id(index.find(editor_id));
+    });
+    printf(
+        "index: %zu entries, %ju bytes, built in %.1f ms, opened in %.1f us\n", index.size(),
+        static_cast<uintmax_t>(std::filesystem::file_size(index_path)),
+        std::chrono::duration<double, std::milli>(built - started).count(),
+        std::chrono::duration<double, std::micro>(opened - built).count()
+    );
+    index.close();
+    std::filesystem::remove(index_path);
+
+    const auto& stats = cache.stats();
+    printf(
+        "cache: %zu entries, %llu hits, %llu misses\n", cache.size(),
+        static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses)
+    );
+    return 0;
+}
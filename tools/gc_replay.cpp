@@ -0,0 +1,196 @@
+// Replays a game session's allocation trace through QuickJS and reports its worst GC pauses
+//
+// Usage: gc-replay [--config FILE] [TRACE]
+//
+// Each line of the trace is one stretch of the session:
+//   <gameplay|menu|loading> <frames> <objects per frame>
+// Every frame runs a script that builds that many small cyclic objects (only the cycle
+// collector frees them, as with most script garbage) and keeps one in a hundred alive for a
+// while. The session is replayed twice in fresh runtimes: once with QuickJS collecting on its
+// own default threshold, and once with GcScheduler driving the threshold from the trace's
+// activity and running its collections from a stand-in frame pump between frames. Frame times
+// include any collection QuickJS ran inside the script; the worst gameplay frame is the pause a
+// player would feel. GC settings come from the [gc] section of --config, like the plugin's INI.
+// Without a trace, a built-in session of play, menus and loading screens is replayed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gc_scheduler.h"
+#include "ini_file.h"
+#include "js_allocator.h"
+#include "quickjs.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Segment {
+        GameActivity activity;
+        int          frames;
+        int          objects;
+    };
+
+    const std::vector<Segment> default_session = {
+        {GameActivity::Gameplay, 600, 4000}, {GameActivity::Menu, 60, 200},
+        {GameActivity::Gameplay, 900, 6000}, {GameActivity::Loading, 120, 0},
+        {GameActivity::Gameplay, 600, 4000},
+    };
+
+    constexpr const char* frame_script = R"(
+        var retained = [];
+        function frame(objects) {
+            for (let i = 0; i < objects; i++) {
+                const node = { id: i, payload: [i, i + 1, i + 2], self: null };
+                node.self = node;
+                if (i % 100 == 0) retained.push(node);
+            }
+            if (retained.length > 20000) retained.splice(0, retained.length - 20000);
+        }
+    )";
+
+    bool parse_activity(const char* name, GameActivity& activity) {
+        if (strcmp(name, "gameplay") == 0) activity = GameActivity::Gameplay;
+        else if (strcmp(name, "menu") == 0) activity = GameActivity::Menu;
+        else if (strcmp(name, "loading") == 0) activity = GameActivity::Loading;
+        else return false;
+        return true;
+    }
+
+    bool load_trace(const char* path, std::vector<Segment>& session) {
+        std::ifstream in(path);
+        if (!in) return false;
+        std::string line;
+        while (std::getline(in, line)) {
+            char    activity[16];
+            Segment segment{};
+            int     fields = sscanf(
+                line.c_str(), " %15s %d %d", activity, &segment.frames, &segment.objects
+            );
+            if (fields == 3 && parse_activity(activity, segment.activity))
+                session.push_back(segment);
+        }
+        return true;
+    }
+
+    struct Report {
+        std::vector<double> gameplay_frames_ms;
+        GcMetrics           gc;
+        size_t              peak_bytes = 0;
+    };
+
+    // Replays `session` in a fresh runtime, driven by a GcScheduler when `settings` is given
+    bool replay(
+        const std::vector<Segment>& session, const GcSchedulerSettings* settings, Report& report
+    ) {
+        PooledJSAllocator allocator;
+        JSRuntime*        rt  = JS_NewRuntime2(&allocator.malloc_functions(), &allocator);
+        JSContext*        ctx = rt ? JS_NewContext(rt) : nullptr;
+        if (!ctx) return false;
+
+        JSValue loaded = JS_Eval(
+            ctx, frame_script, strlen(frame_script), "<gc-replay>", JS_EVAL_TYPE_GLOBAL
+        );
+        JSValue global = JS_GetGlobalObject(ctx);
+        JSValue frame  = JS_GetPropertyStr(ctx, global, "frame");
+        bool    ok     = !JS_IsException(loaded) && JS_IsFunction(ctx, frame);
+        JS_FreeValue(ctx, loaded);
+
+        GcScheduler scheduler;
+        if (settings) {
+            scheduler.set_settings(*settings);
+            scheduler.attach(rt, session.front().activity, &allocator.stats().bytes_in_use);
+        }
+
+        for (const auto& segment : session) {
+            if (!ok) break;
+            if (settings) scheduler.set_activity(segment.activity);
+            for (int n = 0; n < segment.frames && ok; n++) {
+                JSValue objects = JS_NewInt32(ctx, segment.objects);
+                auto    started = Clock::now();
+                JSValue result  = JS_Call(ctx, frame, JS_UNDEFINED, 1, &objects);
+                auto    elapsed = std::chrono::duration<double, std::milli>(Clock::now() - started);
+                ok              = !JS_IsException(result);
+                JS_FreeValue(ctx, result);
+                if (segment.activity == GameActivity::Gameplay)
+                    report.gameplay_frames_ms.push_back(elapsed.count());
+                if (settings) scheduler.on_frame();  // the plugin pumps every frame too
+            }
+        }
+
+        report.gc         = scheduler.metrics();
+        report.peak_bytes = allocator.stats().peak_bytes_in_use;
+        scheduler.detach();
+        JS_FreeValue(ctx, frame);
+        JS_FreeValue(ctx, global);
+        JS_FreeContext(ctx);
+        JS_FreeRuntime(rt);
+        return ok;
+    }
+
+    void print_report(const char* label, Report& report) {
+        auto& frames = report.gameplay_frames_ms;
+        std::sort(frames.begin(), frames.end());
+        double worst = frames.empty() ? 0 : frames.back();
+        double p99   = frames.empty() ? 0 : frames[frames.size() * 99 / 100];
+        printf(
+            "%-10s gameplay frames: worst %7.2f ms, p99 %6.2f ms (%zu frames, peak %.1f MB)\n",
+            label, worst, p99, frames.size(), report.peak_bytes / (1024.0 * 1024.0)
+        );
+        if (report.gc.collections == 0) return;
+        printf(
+            "%-10s %llu scheduled collections (%llu menu, %llu loading, %llu between frames), "
+            "worst pause %.2f ms\n",
+            "", static_cast<unsigned long long>(report.gc.collections),
+            static_cast<unsigned long long>(report.gc.menu_collections),
+            static_cast<unsigned long long>(report.gc.loading_collections),
+            static_cast<unsigned long long>(report.gc.frame_collections), report.gc.max_pause_ms
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* config = nullptr;
+    const char* trace  = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) config = argv[++i];
+        else if (argv[i][0] != '-' && !trace) trace = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [--config FILE] [TRACE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Segment> session;
+    if (trace && !load_trace(trace, session)) {
+        fprintf(stderr, "cannot read %s\n", trace);
+        return 1;
+    }
+    if (!trace) session = default_session;
+    if (session.empty()) {
+        fprintf(stderr, "%s has no segments\n", trace);
+        return 1;
+    }
+
+    IniFile ini;
+    if (config && !ini.load(config)) {
+        fprintf(stderr, "cannot read %s\n", config);
+        return 1;
+    }
+    auto settings = GcSchedulerSettings::from_ini(ini);
+
+    Report unscheduled, scheduled;
+    if (!replay(session, nullptr, unscheduled) || !replay(session, &settings, scheduled)) {
+        fprintf(stderr, "replay failed\n");
+        return 1;
+    }
+    print_report("default", unscheduled);
+    print_report("scheduled", scheduled);
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Decodes a binary log written by the plugin's `jslog binary` mode into plain text
+//
+// Usage: jslog-decode <file.jslog> [more files...]
+
+#include <stdio.h>
+
+#include <ctime>
+
+#include "binary_log.h"
+
+static void print_timestamp(uint64_t timestamp_ns) {
+    time_t seconds = static_cast<time_t>(timestamp_ns / 1'000'000'000);
+    auto   millis  = static_cast<unsigned>((timestamp_ns / 1'000'000) % 1000);
+
+    tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char buffer[32];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+    printf("[%s.%03u] ", buffer, millis);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file.jslog>...\n", argv[0]);
+        return 2;
+    }
+
+    int exit_code = 0;
+    for (int i = 1; i < argc; i++) {
+        BinaryLogReader reader;
+        if (!reader.open(argv[i])) {
+            fprintf(stderr, "%s: %s\n", argv[i], reader.error().c_str());
+            exit_code = 1;
+            continue;
+        }
+
+        BinaryLogReader::Event event;
+        while (reader.next(event)) {
+            print_timestamp(event.timestamp_ns);
+            auto line = binary_log::format_record(event.format, event.args);
+            fwrite(line.data(), 1, line.size(), stdout);
+            fputc('\n', stdout);
+        }
+
+        if (!reader.error().empty()) {
+            fprintf(stderr, "%s: %s\n", argv[i], reader.error().c_str());
+            exit_code = 1;
+        }
+    }
+    return exit_code;
+}
@@ -0,0 +1,537 @@
+// Runs a global Papyrus function from compiled .pex files outside the game
+//
+// Usage: papyrus-host [--scripts <folder|file>]... [--iterations N] [--js]
+//                     <Script.Function> [arg...]
+//        papyrus-host --bench <bind|properties> [--iterations N]
+//
+// The function runs in the reference interpreter against stub natives (Debug.Trace and friends
+// print, Utility returns fixed or random values). With --js the same scripts are transpiled and
+// run in QuickJS too; both results are compared and both timings printed. Arguments are parsed
+// as bool (true/false), int, float, None (none) or else string. tools/fixtures/papyrus holds
+// sample scripts that the xmake tests run this way.
+//
+// --bench runs a micro-benchmark in the same QuickJS setup instead: `bind` times calls from JS
+// into bind<&fn> thunks at arity 0..6 against a hand-written JSCFunction that switches on each
+// argument's type at run time, and against a plain JS function as the floor. `properties` times
+// js_get_property/js_set_property, which use the runtime's interned hot atoms, against
+// JS_GetPropertyStr/JS_SetPropertyStr, which intern the name on every call.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "js_marshal.h"
+#include "papyrus_interpreter.h"
+#include "pex_file.h"
+#include "pex_transpiler.h"
+#include "quickjs.h"
+#include "runtime_state.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    PexValue parse_argument(const char* text) {
+        if (strcmp(text, "true") == 0) return true;
+        if (strcmp(text, "false") == 0) return false;
+        if (strcmp(text, "none") == 0) return {};
+
+        char* end     = nullptr;
+        long  integer = strtol(text, &end, 10);
+        if (*text && !*end) return static_cast<int32_t>(integer);
+        float real = strtof(text, &end);
+        if (*text && !*end) return real;
+        return std::string(text);
+    }
+
+    bool              print_natives = true;
+    Clock::time_point started       = Clock::now();
+    std::mt19937      random(1234);  // fixed seed so runs are repeatable
+
+    template <class T>
+    T argument(std::span<const PexValue> args, size_t index, T fallback) {
+        auto* value = index < args.size() ? std::get_if<T>(&args[index]) : nullptr;
+        return value ? *value : fallback;
+    }
+
+    void register_stub_natives(PexInterpreter& interpreter) {
+        auto print = [](const char* prefix) {
+            return [prefix](const PexValue&, std::span<const PexValue> args) -> PexValue {
+                if (!print_natives) return {};
+                auto message = args.empty() ? std::string{} : pex_value_to_string(args[0]);
+                printf("[%s] %s\n", prefix, message.c_str());
+                return {};
+            };
+        };
+        interpreter.register_native("Debug", "Trace", print("trace"));
+        interpreter.register_native("Debug", "Notification", print("notification"));
+        interpreter.register_native("Debug", "MessageBox", print("messagebox"));
+
+        interpreter.register_native("Utility", "GetCurrentRealTime", [](auto&, auto) -> PexValue {
+            return std::chrono::duration<float>(Clock::now() - started).count();
+        });
+        interpreter.register_native("Utility", "RandomInt", [](auto&, auto args) -> PexValue {
+            int32_t low  = argument<int32_t>(args, 0, 0);
+            int32_t high = argument<int32_t>(args, 1, 100);
+            return std::uniform_int_distribution<int32_t>(low, std::max(low, high))(random);
+        });
+        interpreter.register_native("Utility", "RandomFloat", [](auto&, auto args) -> PexValue {
+            float low  = argument<float>(args, 0, 0.0f);
+            float high = argument<float>(args, 1, 1.0f);
+            return std::uniform_real_distribution<float>(low, std::max(low, high))(random);
+        });
+    }
+
+    JSValue pex_value_to_js(JSContext* ctx, const PexValue& value) {
+        if (auto* b = std::get_if<bool>(&value)) return JS_NewBool(ctx, *b);
+        if (auto* i = std::get_if<int32_t>(&value)) return JS_NewInt32(ctx, *i);
+        if (auto* f = std::get_if<float>(&value)) return JS_NewFloat64(ctx, *f);
+        if (auto* s = std::get_if<std::string>(&value)) return to_js(ctx, *s);
+        return JS_NULL;
+    }
+
+    // JS results are converted by the Papyrus type the function declares
+    PexValue pex_value_from_js(JSContext* ctx, JSValueConst value, std::string_view type) {
+        if (JS_IsNull(value) || JS_IsUndefined(value)) return {};
+        if (type == "int") return from_js<int32_t>(ctx, value).value_or(0);
+        if (type == "float") return static_cast<float>(from_js<double>(ctx, value).value_or(0));
+        if (type == "bool") return JS_ToBool(ctx, value) > 0;
+        if (type == "string") return from_js<std::string>(ctx, value).value_or("");
+        return {};
+    }
+
+    // Native arguments keep the JS value's own type (int-tagged numbers stay ints)
+    PexValue native_argument(JSContext* ctx, JSValueConst arg) {
+        if (JS_IsBool(arg)) return JS_ToBool(ctx, arg) > 0;
+        if (JS_IsString(arg)) return from_js<std::string>(ctx, arg).value_or("");
+        if (JS_VALUE_GET_TAG(arg) == JS_TAG_INT) return from_js<int32_t>(ctx, arg).value_or(0);
+        if (JS_IsNumber(arg)) return static_cast<float>(from_js<double>(ctx, arg).value_or(0));
+        return {};
+    }
+
+    PexInterpreter* native_interpreter = nullptr;
+
+    // native(script, function, ...args): natives of scripts with no transpiled code
+    JSValue js_native(JSContext* ctx, JSValueConst, int argc, JSValueConst* argv) {
+        std::string script, function;
+        if (argc < 2 || !from_js(ctx, argv[0], script) || !from_js(ctx, argv[1], function))
+            return JS_ThrowTypeError(ctx, "native expects a script and function name");
+
+        std::vector<PexValue> args;
+        for (int i = 2; i < argc; i++) args.push_back(native_argument(ctx, argv[i]));
+
+        auto result = native_interpreter->call_static(script, function, args);
+        if (!result.ok) return JS_ThrowInternalError(ctx, "%s", result.error.c_str());
+        return pex_value_to_js(ctx, result.value);
+    }
+
+    // Wires the transpiled scripts to each other; anything else goes to the stub natives
+    constexpr const char* js_host_source = R"(
+        (makeRuntime, scripts, native) => {
+            const rt = makeRuntime({
+                callStatic(script, fn, args) {
+                    const code = scripts[script];
+                    const target = code && code.states[""][fn];
+                    return target ? target(rt, null, ...args) : native(script, fn, ...args);
+                },
+            });
+            return rt;
+        }
+    )";
+
+    void print_js_exception(JSContext* ctx) {
+        JSValue     exception = JS_GetException(ctx);
+        const char* message   = JS_ToCString(ctx, exception);
+        fprintf(stderr, "js: %s\n", message ? message : "(unknown error)");
+        if (message) JS_FreeCString(ctx, message);
+        JS_FreeValue(ctx, exception);
+    }
+
+    JSValue eval(JSContext* ctx, std::string_view source, const char* filename) {
+        std::string code(source);
+        return JS_Eval(ctx, code.c_str(), code.size(), filename, JS_EVAL_TYPE_GLOBAL);
+    }
+
+    std::string lowercase(std::string_view str) {
+        std::string result(str);
+        for (auto& c : result) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    // object[keys[0]][keys[1]]...; undefined when a step is missing
+    JSValue get_path(
+        JSContext* ctx, JSValueConst object, std::initializer_list<const char*> keys
+    ) {
+        JSValue value = JS_DupValue(ctx, object);
+        for (const char* key : keys) {
+            if (!JS_IsObject(value)) break;
+            JSValue next = JS_GetPropertyStr(ctx, value, key);
+            JS_FreeValue(ctx, value);
+            value = next;
+        }
+        return value;
+    }
+
+    struct Timing {
+        double   milliseconds = 0;
+        PexValue result;
+    };
+
+    // Transpiles every loaded script, then runs the function `iterations` times in QuickJS
+    bool run_js(
+        const std::vector<std::unique_ptr<PexFile>>& files, const std::string& script,
+        const std::string& function, std::string_view return_type,
+        const std::vector<PexValue>& args, int iterations, Timing& timing
+    ) {
+        JSRuntime* runtime = JS_NewRuntime();
+        JSContext* ctx     = JS_NewContext(runtime);
+
+        JSValue scripts = JS_NewObject(ctx);
+        for (const auto& file : files) {
+            for (const auto& object : file->objects()) {
+                JSValue code = eval(ctx, transpile_pex_object(*file, object), "<pex-transpiled>");
+                if (JS_IsException(code)) {
+                    print_js_exception(ctx);
+                    continue;
+                }
+                auto name = lowercase(file->string(object.name));
+                JS_SetPropertyStr(ctx, scripts, name.c_str(), code);
+            }
+        }
+        JSValue target = get_path(ctx, scripts, {script.c_str(), "states", "", function.c_str()});
+
+        JSValue host    = eval(ctx, js_host_source, "<papyrus-host>");
+        JSValue setup[] = {
+            eval(ctx, pex_runtime_source(), "<pex-runtime>"), scripts,
+            JS_NewCFunction(ctx, js_native, "native", 2),
+        };
+        JSValue rt = JS_Call(ctx, host, JS_UNDEFINED, 3, setup);
+        for (auto& value : setup) JS_FreeValue(ctx, value);
+        JS_FreeValue(ctx, host);
+
+        bool ok = false;
+        if (JS_IsException(rt)) {
+            print_js_exception(ctx);
+        } else if (!JS_IsFunction(ctx, target)) {
+            fprintf(stderr, "js: %s.%s was not transpiled\n", script.c_str(), function.c_str());
+        } else {
+            std::vector<JSValue> call_args{JS_DupValue(ctx, rt), JS_NULL};
+            for (const auto& arg : args) call_args.push_back(pex_value_to_js(ctx, arg));
+
+            ok           = true;
+            auto started = Clock::now();
+            for (int i = 0; i < iterations && ok; i++) {
+                JSValue result = JS_Call(
+                    ctx, target, JS_UNDEFINED, static_cast<int>(call_args.size()), call_args.data()
+                );
+                if (JS_IsException(result)) {
+                    print_js_exception(ctx);
+                    ok = false;
+                } else if (i == iterations - 1) {
+                    timing.result = pex_value_from_js(ctx, result, return_type);
+                }
+                JS_FreeValue(ctx, result);
+            }
+            timing.milliseconds =
+                std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+            for (auto& value : call_args) JS_FreeValue(ctx, value);
+        }
+
+        JS_FreeValue(ctx, target);
+        JS_FreeValue(ctx, rt);
+        JS_FreeContext(ctx);
+        JS_FreeRuntime(runtime);
+        return ok;
+    }
+
+    bool load_scripts(
+        const std::filesystem::path& path, std::vector<std::unique_ptr<PexFile>>& files
+    ) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(path, ec)) {
+            auto file = std::make_unique<PexFile>();
+            if (!file->load(path)) {
+                fprintf(stderr, "%s: %s\n", path.string().c_str(), file->error().c_str());
+                return false;
+            }
+            files.push_back(std::move(file));
+            return true;
+        }
+
+        bool ok = true;
+        for (auto& entry : load_pex_directory(path)) {
+            if (entry.ok) {
+                files.push_back(std::move(entry.file));
+                continue;
+            }
+            fprintf(stderr, "%s: %s\n", entry.path.string().c_str(), entry.file->error().c_str());
+            ok = false;
+        }
+        return ok;
+    }
+
+    const pex::Function* find_global_function(
+        const std::vector<std::unique_ptr<PexFile>>& files, const std::string& script,
+        const std::string& function, const PexFile*& owner
+    ) {
+        for (const auto& file : files) {
+            for (const auto& object : file->objects()) {
+                if (lowercase(file->string(object.name)) != script) continue;
+                owner = file.get();
+                return file->find_function(object, "", function);
+            }
+        }
+        return nullptr;
+    }
+
+    void print_timing(const char* label, const Timing& timing, int iterations) {
+        printf(
+            "%-12s %d calls in %.3f ms (%.3f us/call)\n", label, iterations, timing.milliseconds,
+            timing.milliseconds * 1000.0 / iterations
+        );
+    }
+
+    int usage(const char* program) {
+        fprintf(
+            stderr,
+            "usage: %s [--scripts <folder|file>]... [--iterations N] [--js] <Script.Function> "
+            "[arg...]\n"
+            "       %s --bench <bind|properties> [--iterations N]\n",
+            program, program
+        );
+        return 2;
+    }
+
+    // Functions for `--bench bind`: ints and floats alternate, as in most Papyrus signatures
+    double bound0() { return 0; }
+    double bound1(int32_t a) { return a; }
+    double bound2(int32_t a, double b) { return a + b; }
+    double bound3(int32_t a, double b, int32_t c) { return a + b + c; }
+    double bound4(int32_t a, double b, int32_t c, double d) { return a + b + c + d; }
+    double bound5(int32_t a, double b, int32_t c, double d, int32_t e) {
+        return a + b + c + d + e;
+    }
+    double bound6(int32_t a, double b, int32_t c, double d, int32_t e, double f) {
+        return a + b + c + d + e + f;
+    }
+
+    // What bindings looked like before bind<>: one type switch per argument at run time
+    JSValue hand_written(JSContext* ctx, JSValueConst, int argc, JSValueConst* argv) {
+        double sum = 0;
+        for (int i = 0; i < argc; i++) {
+            switch (JS_VALUE_GET_TAG(argv[i])) {
+                case JS_TAG_INT:
+                    sum += JS_VALUE_GET_INT(argv[i]);
+                    break;
+                default:
+                    double number;
+                    if (JS_ToFloat64(ctx, &number, argv[i]) < 0) return JS_EXCEPTION;
+                    sum += number;
+            }
+        }
+        return JS_NewFloat64(ctx, sum);
+    }
+
+    // Nanoseconds per call of `function` with `arity` arguments, called from a JS loop
+    double time_calls(JSContext* ctx, JSValueConst function, int arity, int iterations) {
+        constexpr const char* values[] = {"1", "2.5", "3", "4.5", "5", "6.5"};
+        std::string source = "(f, n) => { let s = 0; for (let i = 0; i < n; i++) s += f(";
+        for (int i = 0; i < arity; i++) source += std::string(i ? ", " : "") + values[i];
+        source += "); return s; }";
+
+        JSValue loop    = eval(ctx, source, "<bench>");
+        JSValue args[]  = {JS_DupValue(ctx, function), JS_NewInt32(ctx, iterations)};
+        auto    started = Clock::now();
+        JSValue result  = JS_Call(ctx, loop, JS_UNDEFINED, 2, args);
+        auto    elapsed = std::chrono::duration<double, std::nano>(Clock::now() - started);
+        if (JS_IsException(result)) print_js_exception(ctx);
+        JS_FreeValue(ctx, result);
+        for (auto& arg : args) JS_FreeValue(ctx, arg);
+        JS_FreeValue(ctx, loop);
+        return elapsed.count() / iterations;
+    }
+
+    int bench_bind(int iterations) {
+        JSRuntime* runtime = JS_NewRuntime();
+        JSContext* ctx     = JS_NewContext(runtime);
+
+        JSValue bound[] = {
+            bind<&bound0>(ctx, "bound0"), bind<&bound1>(ctx, "bound1"),
+            bind<&bound2>(ctx, "bound2"), bind<&bound3>(ctx, "bound3"),
+            bind<&bound4>(ctx, "bound4"), bind<&bound5>(ctx, "bound5"),
+            bind<&bound6>(ctx, "bound6"),
+        };
+        JSValue hand = JS_NewCFunction(ctx, hand_written, "handWritten", 0);
+        JSValue js   = eval(ctx, "(a, b, c, d, e, f) => 0", "<bench>");
+
+        printf("%d calls per arity, ns/call\n", iterations);
+        printf("arity  bind<>  hand-written  JS function\n");
+        for (int arity = 0; arity <= 6; arity++) {
+            printf(
+                "%5d  %6.1f  %12.1f  %11.1f\n", arity,
+                time_calls(ctx, bound[arity], arity, iterations),
+                time_calls(ctx, hand, arity, iterations), time_calls(ctx, js, arity, iterations)
+            );
+        }
+
+        for (auto& function : bound) JS_FreeValue(ctx, function);
+        JS_FreeValue(ctx, hand);
+        JS_FreeValue(ctx, js);
+        JS_FreeContext(ctx);
+        JS_FreeRuntime(runtime);
+        return 0;
+    }
+
+    // Nanoseconds per run of `access`
+    template <class Access>
+    double time_accesses(int iterations, Access access) {
+        auto started = Clock::now();
+        for (int i = 0; i < iterations; i++) access();
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - started);
+        return elapsed.count() / iterations;
+    }
+
+    int bench_properties(int iterations) {
+        // Set up like the plugin's runtimes, so js_atom finds the interned atoms
+        auto       state   = std::make_unique<RuntimeState>();
+        auto&      allocator = state->allocator;
+        JSRuntime* runtime   = JS_NewRuntime2(&allocator.malloc_functions(), &allocator);
+        JS_SetRuntimeOpaque(runtime, state.get());
+        JSContext* ctx = JS_NewContext(runtime);
+        state->atoms.init(ctx);
+
+        JSValue reference = eval(ctx, "({ formID: 20, name: 'A', x: 1, y: 2, z: 3 })", "<bench>");
+        JSValue array     = eval(ctx, "[1, 2, 3]", "<bench>");
+        struct Case {
+            JSValueConst object;
+            JSAtomName   name;
+        };
+        // `then` is absent, so its lookups walk the prototype chain, as promise checks do
+        const Case cases[] = {
+            {reference, JSAtomName::formID}, {reference, JSAtomName::x},
+            {reference, JSAtomName::name},   {reference, JSAtomName::then},
+            {array, JSAtomName::length},
+        };
+
+        printf("%d accesses per property, ns/access\n", iterations);
+        printf("property  js_get_property  GetPropertyStr  js_set_property  SetPropertyStr\n");
+        for (const auto& [object, name] : cases) {
+            const char* text  = js_atom_names[static_cast<size_t>(name)];
+            JSValue     value = js_get_property(ctx, object, name);  // written back by the sets
+
+            auto get     = [&] { JS_FreeValue(ctx, js_get_property(ctx, object, name)); };
+            auto get_str = [&] { JS_FreeValue(ctx, JS_GetPropertyStr(ctx, object, text)); };
+            auto set     = [&] { js_set_property(ctx, object, name, JS_DupValue(ctx, value)); };
+            auto set_str = [&] { JS_SetPropertyStr(ctx, object, text, JS_DupValue(ctx, value)); };
+            printf(
+                "%-8s  %15.1f  %14.1f  %15.1f  %14.1f\n", text, time_accesses(iterations, get),
+                time_accesses(iterations, get_str), time_accesses(iterations, set),
+                time_accesses(iterations, set_str)
+            );
+            JS_FreeValue(ctx, value);
+        }
+
+        JS_FreeValue(ctx, reference);
+        JS_FreeValue(ctx, array);
+        state->atoms.release(runtime);
+        JS_FreeContext(ctx);
+        JS_FreeRuntime(runtime);
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::filesystem::path> paths;
+    int                                iterations = 0;
+    bool                               js         = false;
+    const char*                        bench      = nullptr;
+
+    int i = 1;
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+        if (strcmp(argv[i], "--scripts") == 0 && i + 1 < argc) paths.push_back(argv[++i]);
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--js") == 0) js = true;
+        else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) bench = argv[++i];
+        else return usage(argv[0]);
+    }
+    if (bench) {
+        int count = iterations ? iterations : 1000000;
+        if (strcmp(bench, "bind") == 0) return bench_bind(count);
+        if (strcmp(bench, "properties") == 0) return bench_properties(count);
+        return usage(argv[0]);
+    }
+    iterations = std::max(iterations, 1);
+    const char* dot = i < argc ? strchr(argv[i], '.') : nullptr;
+    if (!dot) return usage(argv[0]);
+
+    std::string           script   = lowercase(std::string_view(argv[i], dot));
+    std::string           function = lowercase(dot + 1);
+    std::vector<PexValue> args;
+    for (i++; i < argc; i++) args.push_back(parse_argument(argv[i]));
+
+    if (paths.empty()) paths.push_back(".");
+    std::vector<std::unique_ptr<PexFile>> files;
+    for (const auto& path : paths) load_scripts(path, files);
+
+    const PexFile* owner  = nullptr;
+    const auto*    target = find_global_function(files, script, function, owner);
+    if (!target || !target->is_global()) {
+        fprintf(
+            stderr, "no global function %s.%s in the loaded scripts\n", script.c_str(),
+            function.c_str()
+        );
+        return 1;
+    }
+    auto return_type = lowercase(owner->string(target->return_type));
+
+    PexInterpreter interpreter;
+    for (const auto& file : files) interpreter.add_script(*file);
+    register_stub_natives(interpreter);
+
+    // Natives print on the first call only, so timing runs are not dominated by output
+    Timing        interpreted;
+    PexCallResult result;
+    auto          started = Clock::now();
+    for (int n = 0; n < iterations; n++) {
+        result = interpreter.call_static(script, function, args);
+        if (!result.ok) break;
+        print_natives = false;
+    }
+    interpreted.milliseconds =
+        std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    if (!result.ok) {
+        fprintf(stderr, "error: %s\n", result.error.c_str());
+        return 1;
+    }
+    interpreted.result = result.value;
+
+    printf("result:      %s\n", pex_value_to_string(interpreted.result).c_str());
+    print_timing("interpreter:", interpreted, iterations);
+    printf(
+        "             %.1f instructions/call\n",
+        double(interpreter.instructions_executed()) / iterations
+    );
+    if (!js) return 0;
+
+    Timing transpiled;
+    native_interpreter = &interpreter;
+    if (!run_js(files, script, function, return_type, args, iterations, transpiled)) return 1;
+    print_timing("quickjs:", transpiled, iterations);
+    if (transpiled.milliseconds > 0)
+        printf("             %.1fx\n", interpreted.milliseconds / transpiled.milliseconds);
+
+    auto expected = pex_value_to_string(interpreted.result);
+    auto actual   = pex_value_to_string(transpiled.result);
+    if (expected != actual) {
+        fprintf(stderr, "mismatch: interpreter %s, quickjs %s\n", expected.c_str(), actual.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Parses every .pex file in one or more folders and reports totals and timing
+//
+// Usage: pex-scan [--threads N] [--check] <folder>...
+//
+// --check verifies instead of timing: files named *.bad.pex must be rejected, every other file
+// must parse, and each parsed instruction must have at least its opcode's fixed operands with
+// every identifier and string operand inside the string table. tools/fixtures/pex holds a valid
+// script, one with variadic calls and a truncated copy; `xmake test` runs the check on them.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "pex_file.h"
+
+namespace {
+    bool is_expected_bad(const std::filesystem::path& path) {
+        return path.stem().extension() == ".bad";
+    }
+
+    // Why the operands of `function` are inconsistent with its instructions, or nullptr
+    const char* check_function(const PexFile& file, const pex::Function& function) {
+        for (const auto& instruction : function.instructions) {
+            if (instruction.operand_count < pex::opcode_info(instruction.opcode).operands)
+                return "instruction with too few operands";
+            for (const auto& value : function.operands_of(instruction)) {
+                bool names_string = value.type == pex::ValueType::identifier ||
+                                    value.type == pex::ValueType::string;
+                if (names_string && value.string_index >= file.strings().size())
+                    return "operand outside the string table";
+            }
+        }
+        return nullptr;
+    }
+
+    const char* check_file(const PexFile& file) {
+        for (const auto& object : file.objects()) {
+            for (const auto& function : object.accessors) {
+                if (auto* error = check_function(file, function)) return error;
+            }
+            for (const auto& state : object.states) {
+                for (const auto& function : state.functions) {
+                    if (auto* error = check_function(file, function)) return error;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    bool check(const char* folder, unsigned threads) {
+        auto entries = load_pex_directory(folder, threads);
+        bool passed  = !entries.empty();
+        for (const auto& entry : entries) {
+            const char* error = entry.ok ? check_file(*entry.file) : entry.file->error().c_str();
+            bool        bad   = error != nullptr;
+            if (bad == is_expected_bad(entry.path)) {
+                printf(
+                    "ok    %s%s%s\n", entry.path.string().c_str(), bad ? ": " : "",
+                    bad ? error : ""
+                );
+            } else {
+                printf(
+                    "FAIL  %s: %s\n", entry.path.string().c_str(),
+                    bad ? error : "parsed but should be rejected"
+                );
+                passed = false;
+            }
+        }
+        if (entries.empty()) fprintf(stderr, "%s: no .pex files\n", folder);
+        return passed;
+    }
+}
+
+int main(int argc, char** argv) {
+    unsigned threads    = 0;
+    bool     checking   = false;
+    int      first_path = 1;
+    for (; first_path < argc && strncmp(argv[first_path], "--", 2) == 0; first_path++) {
+        if (strcmp(argv[first_path], "--threads") == 0 && first_path + 1 < argc)
+            threads = static_cast<unsigned>(atoi(argv[++first_path]));
+        else if (strcmp(argv[first_path], "--check") == 0) checking = true;
+        else break;
+    }
+    if (first_path >= argc || strncmp(argv[first_path], "--", 2) == 0) {
+        fprintf(stderr, "usage: %s [--threads N] [--check] <folder>...\n", argv[0]);
+        return 2;
+    }
+
+    int exit_code = 0;
+    for (int i = first_path; i < argc; i++) {
+        if (checking) {
+            if (!check(argv[i], threads)) exit_code = 1;
+            continue;
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        auto entries = load_pex_directory(argv[i], threads);
+        auto elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - started
+        );
+
+        size_t parsed = 0, functions = 0, instructions = 0;
+        for (const auto& entry : entries) {
+            if (!entry.ok) {
+                fprintf(
+                    stderr, "%s: %s\n", entry.path.string().c_str(), entry.file->error().c_str()
+                );
+                exit_code = 1;
+                continue;
+            }
+            parsed++;
+            for (const auto& object : entry.file->objects()) {
+                for (const auto& state : object.states) {
+                    functions += state.functions.size();
+                    for (const auto& function : state.functions)
+                        instructions += function.instructions.size();
+                }
+            }
+        }
+
+        printf(
+            "%s: %zu/%zu files, %zu functions, %zu instructions in %.1f ms\n", argv[i], parsed,
+            entries.size(), functions, instructions, elapsed.count()
+        );
+    }
+    return exit_code;
+}
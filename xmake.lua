@@ -14,6 +14,7 @@ add_repositories("SkyrimScripting     https://github.com/SkyrimScripting/Package
 add_repositories("SkyrimScriptingBeta https://github.com/SkyrimScriptingBeta/Packages.git")
 add_repositories("MrowrLib            https://github.com/MrowrLib/Packages.git")
 
+add_moduledirs("xmake/modules")
 includes("xmake/*.lua")
 
 add_requires("quickjs-ng")
@@ -33,6 +34,7 @@ skse_plugin({
     author = "Mrowr Purr",
     email = "mrowr.purr@gmail.com",
     -- mod_files = {"Scripts"},
+    papyrus_bindings = "Scripts/Source",
     -- deps = {"Build Papyrus Scripts"},
     packages = {
         "SkyrimScripting.Plugin",
@@ -40,3 +42,71 @@ skse_plugin({
         "quickjs-ng"
     }
 })
+
+-- Host tools (no SKSE dependencies)
+
+target("jslog-decode")
+    set_kind("binary")
+    add_files("tools/jslog_decode.cpp", "src/binary_log.cpp")
+    add_includedirs("src")
+
+target("pex-scan")
+    set_kind("binary")
+    add_files("tools/pex_scan.cpp", "src/pex_file.cpp", "src/mapped_file.cpp")
+    add_includedirs("src")
+    add_tests("fixtures", { runargs = { "--check", "tools/fixtures/pex" }, rundir = os.projectdir() })
+
+target("psc-index")
+    set_kind("binary")
+    add_files("tools/psc_index.cpp", "src/psc_index.cpp", "src/psc_file.cpp", "src/mapped_file.cpp")
+    add_includedirs("src")
+
+target("form-bench")
+    set_kind("binary")
+    add_files("tools/form_bench.cpp", "src/editor_id_index.cpp", "src/mapped_file.cpp")
+    add_includedirs("src")
+
+target("alloc-bench")
+    set_kind("binary")
+    add_files("tools/alloc_bench.cpp", "src/js_allocator.cpp")
+    add_includedirs("src")
+    add_packages("quickjs-ng")
+
+target("call-bench")
+    set_kind("binary")
+    add_files("tools/call_bench.cpp", "src/papyrus_call_queue.cpp")
+    add_includedirs("src")
+
+target("gc-replay")
+    set_kind("binary")
+    add_files(
+        "tools/gc_replay.cpp",
+        "src/gc_scheduler.cpp",
+        "src/ini_file.cpp",
+        "src/js_allocator.cpp"
+    )
+    add_includedirs("src")
+    add_packages("quickjs-ng")
+
+target("papyrus-host")
+    set_kind("binary")
+    add_files(
+        "tools/papyrus_host.cpp",
+        "src/js_allocator.cpp",
+        "src/js_atoms.cpp",
+        "src/papyrus_interpreter.cpp",
+        "src/pex_transpiler.cpp",
+        "src/pex_file.cpp",
+        "src/mapped_file.cpp"
+    )
+    add_includedirs("src")
+    add_packages("quickjs-ng")
+
+    -- Each sample runs in the interpreter and in QuickJS; a differing result fails the test
+    local samples = { "--scripts", "tools/fixtures/papyrus", "--js" }
+    add_tests("loop", { runargs = table.join(samples, "PapyrusSample.SumTo", "10"), rundir = os.projectdir() })
+    add_tests("arrays", { runargs = table.join(samples, "PapyrusSample.Squares", "6"), rundir = os.projectdir() })
+    add_tests("floats", { runargs = table.join(samples, "PapyrusSample.Compare", "16.0"), rundir = os.projectdir() })
+    add_tests("saturate", { runargs = table.join(samples, "PapyrusSample.Compare", "3e10"), rundir = os.projectdir() })
+    add_tests("casts", { runargs = table.join(samples, "PapyrusSample.Casts"), rundir = os.projectdir() })
+    add_tests("discard", { runargs = table.join(samples, "PapyrusSample.Discard", "10"), rundir = os.projectdir() })
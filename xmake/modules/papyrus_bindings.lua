@@ -0,0 +1,235 @@
+-- Generates the JS bridge's Papyrus native bindings from .psc declarations
+--
+-- Every `native` function in the source folder gets a dispatch slot, a declaration entry and a
+-- C++ thunk that forwards to call_papyrus_native (or call_latent_papyrus_native for natives
+-- marked with a trailing `; @latent` comment). The output is included by src/papyrus_natives.cpp.
+--
+-- Member (non-global) natives take the script's `extends` type as `self` and go through
+-- call_papyrus_method: a class registered with Papyrus.registerClass receives the call on the
+-- JS object bound to `self`, and a registerNative handler receives `self` as its first argument.
+-- Latent members always use their registerNative handler.
+
+-- Papyrus types that map onto C++ parameter/return types
+local value_types = {
+    ["bool"]   = "bool",
+    ["int"]    = "int32_t",
+    ["float"]  = "float",
+    ["string"] = "std::string",
+}
+
+-- Script types that map onto game form classes
+local form_types = {
+    ["form"]            = "RE::TESForm",
+    ["objectreference"] = "RE::TESObjectREFR",
+    ["actor"]           = "RE::Actor",
+    ["actorbase"]       = "RE::TESNPC",
+    ["armor"]           = "RE::TESObjectARMO",
+    ["cell"]            = "RE::TESObjectCELL",
+    ["faction"]         = "RE::TESFaction",
+    ["globalvariable"]  = "RE::TESGlobal",
+    ["keyword"]         = "RE::BGSKeyword",
+    ["location"]        = "RE::BGSLocation",
+    ["miscobject"]      = "RE::TESObjectMISC",
+    ["quest"]           = "RE::TESQuest",
+    ["spell"]           = "RE::SpellItem",
+    ["weapon"]          = "RE::TESObjectWEAP",
+}
+
+-- Case-insensitive pattern for a Papyrus keyword
+local function keyword(word)
+    return (word:gsub("%a", function (c) return "[" .. c:lower() .. c:upper() .. "]" end))
+end
+
+local function trim(s)
+    return (s:gsub("^%s+", ""):gsub("%s+$", ""))
+end
+
+local function cpp_type(papyrus_type, where)
+    local lowered  = papyrus_type:lower()
+    local is_array = lowered:sub(-2) == "[]"
+    if is_array then
+        lowered = lowered:sub(1, -3)
+    end
+
+    local cpp = value_types[lowered]
+    if not cpp and form_types[lowered] then
+        cpp = form_types[lowered] .. "*"
+    end
+    if not cpp then
+        raise("%s: unsupported Papyrus type '%s'", where, papyrus_type)
+    end
+    return is_array and ("std::vector<" .. cpp .. ">") or cpp
+end
+
+-- Removes {block comments} and joins lines continued with a trailing backslash
+local function logical_lines(source)
+    source = source:gsub("{.-}", function (comment)
+        return (comment:gsub("[^\n]", ""))
+    end)
+    source = source:gsub("\\%s*\n", " ")
+
+    local lines = {}
+    for line in (source .. "\n"):gmatch("(.-)\r?\n") do
+        table.insert(lines, line)
+    end
+    return lines
+end
+
+local function parse_parameters(text, where)
+    local parameters = {}
+    for item in text:gmatch("[^,]+") do
+        local parameter = trim(item:gsub("=.*$", ""))
+        if parameter ~= "" then
+            local type_name, name = parameter:match("^([%w_]+%s*%[?%]?)%s+([%w_]+)$")
+            if not type_name then
+                raise("%s: cannot parse parameter '%s'", where, parameter)
+            end
+            table.insert(parameters, {type = type_name:gsub("%s", ""), name = name})
+        end
+    end
+    return parameters
+end
+
+-- Returns the script name, its parent and the native functions it declares
+function parse_script(file)
+    local script             = {natives = {}}
+    local scriptname_pattern = "^%s*" .. keyword("scriptname") .. "%s+([%w_:]+)(.*)$"
+    local extends_pattern    = keyword("extends") .. "%s+([%w_:]+)"
+    local function_pattern   = "^%s*([%w_]*%s*%[?%]?)%s*" .. keyword("function") ..
+                               "%s+([%w_]+)%s*%((.-)%)(.*)$"
+
+    for index, raw_line in ipairs(logical_lines(io.readfile(file))) do
+        local where         = path.filename(file) .. ":" .. index
+        local code, comment = raw_line:match("^([^;]*);?(.*)$")
+
+        local name, rest = code:match(scriptname_pattern)
+        if name then
+            script.name    = name
+            script.extends = rest:match(extends_pattern)
+        end
+
+        local return_type, function_name, parameters, flags = code:match(function_pattern)
+        if function_name and (" " .. flags:lower() .. " "):find("%snative%s") then
+            if not script.name then
+                raise("%s: native declared before ScriptName", where)
+            end
+            return_type = trim(return_type)
+            table.insert(script.natives, {
+                script      = script.name,
+                name        = function_name,
+                return_type = return_type ~= "" and return_type or nil,
+                parameters  = parse_parameters(parameters, where),
+                global      = (" " .. flags:lower() .. " "):find("%sglobal%s") ~= nil,
+                latent      = comment:find("@latent", 1, true) ~= nil,
+                where       = where,
+            })
+        end
+    end
+    return script
+end
+
+local function emit_native(native, script, out)
+    local slot   = native.script .. "_" .. native.name
+    local thunk  = slot .. "_thunk"
+    local result = native.return_type and cpp_type(native.return_type, native.where) or "void"
+
+    local parameters = {}
+    local arguments  = {slot}
+    if native.latent then
+        if result == "void" then
+            raise("%s: latent native %s.%s must return a value", native.where, native.script,
+                native.name)
+        end
+        table.insert(parameters, "RE::BSScript::Internal::VirtualMachine*")
+        table.insert(parameters, "RE::VMStackID stack_id")
+        table.insert(arguments, "stack_id")
+    end
+    if native.global then
+        table.insert(parameters, "RE::StaticFunctionTag*")
+    else
+        local self_type = script.extends and form_types[script.extends:lower()]
+        if not self_type then
+            raise("%s: member native %s.%s needs a script that extends a form type",
+                native.where, native.script, native.name)
+        end
+        table.insert(parameters, self_type .. "* self")
+        table.insert(arguments, "self")
+    end
+    for _, parameter in ipairs(native.parameters) do
+        table.insert(parameters, cpp_type(parameter.type, native.where) .. " " .. parameter.name)
+        table.insert(arguments, parameter.name)
+    end
+
+    local call = "call_papyrus_native<" .. result .. ">"
+    if native.latent then
+        call = "call_latent_papyrus_native<" .. result .. ">"
+    elseif not native.global then
+        call = "call_papyrus_method<" .. result .. ">"
+    end
+    local signature = string.format("    %s %s(%s) {", native.latent and "bool" or result, thunk,
+        table.concat(parameters, ", "))
+    if #signature > 100 then
+        signature = string.format("    %s %s(\n        %s\n    ) {",
+            native.latent and "bool" or result, thunk, table.concat(parameters, ", "))
+    end
+    table.insert(out.thunks, string.format("%s\n        %s%s(%s);\n    }\n", signature,
+        result == "void" and not native.latent and "" or "return ", call,
+        table.concat(arguments, ", ")))
+
+    table.insert(out.slots, "        " .. slot .. ",")
+    table.insert(out.declarations, string.format("        {\"%s\", \"%s\", %d, %s, %s},",
+        native.script, native.name, #native.parameters, tostring(native.latent),
+        tostring(not native.global)))
+
+    if native.latent then
+        table.insert(out.registrations, string.format(
+            "        vm->RegisterLatentFunction<%s>(\"%s\", \"%s\", %s);",
+            result, native.name, native.script, thunk))
+    else
+        table.insert(out.registrations, string.format(
+            "        vm->RegisterFunction(\"%s\", \"%s\", %s);", native.name, native.script, thunk))
+    end
+end
+
+-- Writes the bindings for every .psc in `source_dir` to `output_file` (only when they changed)
+function generate(source_dir, output_file)
+    local files = os.files(path.join(source_dir, "*.psc"))
+    table.sort(files)
+
+    local out = {slots = {}, declarations = {}, thunks = {}, registrations = {}}
+    for _, file in ipairs(files) do
+        local script = parse_script(file)
+        for _, native in ipairs(script.natives) do
+            emit_native(native, script, out)
+        end
+    end
+
+    local content = table.concat({
+        "// Generated from " .. path.relative(source_dir, os.projectdir()) .. "/*.psc by " ..
+            "xmake/modules/papyrus_bindings.lua",
+        "// Do not edit: add or change native declarations in the .psc files instead",
+        "",
+        "#pragma once",
+        "",
+        "namespace papyrus_natives_generated {",
+        "    enum PapyrusNativeSlot : size_t {",
+        table.concat(out.slots, "\n"),
+        "    };",
+        "",
+        "    constexpr std::array<PapyrusNativeDeclaration, " .. #out.slots .. "> declarations{{",
+        table.concat(out.declarations, "\n"),
+        "    }};",
+        "",
+        table.concat(out.thunks, "\n"),
+        "    void register_natives(RE::BSScript::IVirtualMachine* vm) {",
+        table.concat(out.registrations, "\n"),
+        "    }",
+        "}",
+        "",
+    }, "\n")
+
+    if not os.isfile(output_file) or io.readfile(output_file) ~= content then
+        io.writefile(output_file, content)
+        print("Generated %d Papyrus native binding(s) in %s", #out.slots, output_file)
+    end
+end
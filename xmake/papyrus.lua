@@ -10,3 +10,40 @@ function compile_papyrus_scripts()
         os.exec("pyro -i " .. ppj_path .. " --game-path \"" .. skyrim_with_ck .. "\"")
     end)
 end
+
+-- Generates the JS bridge's native bindings from the target's .psc files before it builds
+-- (see xmake/modules/papyrus_bindings.lua); the output lands in $(buildir)/generated
+function generate_papyrus_bindings(source_dir)
+    add_includedirs("$(buildir)/generated")
+    set_values("papyrus_bindings.source", source_dir)
+    before_build(function (target)
+        import("core.project.config")
+        import("papyrus_bindings")
+        papyrus_bindings.generate(
+            path.join(os.projectdir(), target:values("papyrus_bindings.source")),
+            path.join(config.buildir(), "generated", "papyrus_natives.generated.h")
+        )
+    end)
+end
+
+-- `xmake papyrus-bindings` runs the generator on its own (no SKSE toolchain needed)
+task("papyrus-bindings")
+    set_category("plugin")
+    on_run(function ()
+        import("core.base.option")
+        import("core.project.config")
+        import("papyrus_bindings")
+        config.load()
+        local output = option.get("output") or
+            path.join(config.buildir(), "generated", "papyrus_natives.generated.h")
+        papyrus_bindings.generate(path.join(os.projectdir(), option.get("source")), output)
+    end)
+    set_menu({
+        usage = "xmake papyrus-bindings [options]",
+        description = "Generate Papyrus native bindings from .psc declarations",
+        options = {
+            {"s", "source", "kv", "Scripts/Source", "Folder containing the .psc files"},
+            {"o", "output", "kv", nil, "Header to write (defaults to the build's generated folder)"},
+        }
+    })
+task_end()
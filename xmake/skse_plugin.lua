@@ -14,6 +14,9 @@ function skse_plugin(plugin_info)
         if plugin_info.include then
             add_includedirs(plugin_info.include)
         end
+        if plugin_info.papyrus_bindings then
+            generate_papyrus_bindings(plugin_info.papyrus_bindings)
+        end
         add_packages("skyrim-commonlib-" .. commonlib_version)
         add_rules("@skyrim-commonlib-" .. commonlib_version .. "/plugin", {
             mod_name = plugin_info.name .. " (" .. commonlib_version:upper() .. ")",